@@ -0,0 +1,27 @@
+#!/bin/bash
+# usage: bench_solvers.sh "<engines>" "<problem numbers>" <solver binary>...
+# runs every engine on every problem with each binary (from src/), and prints the total wall clock time.
+# time steps are compared with the first binary, since build options must not change solutions.
+engines=$1
+probs=$2
+shift 2
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+base_time=
+for bin in "$@"; do
+  name=$(basename "$bin")
+  start=$(date +%s%N)
+  for e in $engines; do
+    for p in $probs; do
+      steps=$("$bin" run "$e" --desc "../dataset/problems/prob-$p.desc" 2>/dev/null | grep "Time step")
+      echo "$e $p $steps" >> "$dir/$name"
+    done
+  done
+  end=$(date +%s%N)
+  ms=$(( (end - start) / 1000000 ))
+  [ -z "$base_time" ] && base_time=$ms && base=$name
+  same=same
+  cmp -s "$dir/$base" "$dir/$name" || same=DIFFERENT
+  echo "$name: ${ms} ms (x$(awk "BEGIN { printf \"%.2f\", $base_time / ($ms > 0 ? $ms : 1) }") vs $base, time steps: $same)"
+done
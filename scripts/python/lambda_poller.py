@@ -18,6 +18,7 @@ EngineResult = collections.namedtuple('EngineResult', ('engine_name', 'time'))
 
 
 TIMEOUT = 400.0
+PUZZLE_SEARCH_TIME = 300.0
 INFINITE = 10**9
 SLEEP_TIME = 60.0
 PUBLIC_ID = '164'
@@ -32,8 +33,10 @@ def solve_puzzle(args):
     if os.path.isfile(PUZZLE_OUTPUT_FILE_NAME):
         os.remove(PUZZLE_OUTPUT_FILE_NAME)
 
+    # seeds are tried until PUZZLE_SEARCH_TIME, and the hardest valid puzzle is written.
     command = [args.puzzle_solver_file_path, 'puzzle_run', 'outBFS', '--cond', PUZZLE_INPUT_FILE_NAME,
-               '--output', PUZZLE_OUTPUT_FILE_NAME]
+               '--output', PUZZLE_OUTPUT_FILE_NAME, '--candidates', str(args.puzzle_candidates),
+               '--time-limit', str(PUZZLE_SEARCH_TIME)]
     print(command, flush=True)
     try:
         completed_process = subprocess.run(command, stdout=subprocess.PIPE,
@@ -106,6 +109,8 @@ def main():
                         default='mining_engine_names.txt')
     parser.add_argument('--puzzle_solver_file_path', help='File path of the puzzle solver.',
                         default='src/solver')
+    parser.add_argument('--puzzle_candidates', type=int, help='Number of seeds of the puzzle solver.',
+                        default=64)
     parser.add_argument('--jobs', type=int, help='Number of jobs,',
                         default=multiprocessing.cpu_count())
     parser.add_argument('--engine_file_path', help='File path of the engine.',
@@ -0,0 +1,261 @@
+#include "bit_grid.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// Kogge-Stone fill of seeds x along the runs of g toward higher/lower bits.
+uint64_t fillUp(uint64_t x, uint64_t g) {
+  x &= g;
+  x |= g & (x << 1); g &= g << 1;
+  x |= g & (x << 2); g &= g << 2;
+  x |= g & (x << 4); g &= g << 4;
+  x |= g & (x << 8); g &= g << 8;
+  x |= g & (x << 16); g &= g << 16;
+  x |= g & (x << 32);
+  return x;
+}
+
+uint64_t fillDown(uint64_t x, uint64_t g) {
+  x &= g;
+  x |= g & (x >> 1); g &= g >> 1;
+  x |= g & (x >> 2); g &= g >> 2;
+  x |= g & (x >> 4); g &= g >> 4;
+  x |= g & (x >> 8); g &= g >> 8;
+  x |= g & (x >> 16); g &= g >> 16;
+  x |= g & (x >> 32);
+  return x;
+}
+
+// extend seeds s (a subset of f) to the whole runs of f in a row.
+void fillRow(uint64_t* s, const uint64_t* f, int words) {
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (int k = 0; k < words; ++k) {
+      uint64_t x = s[k];
+      if (k > 0 && (s[k - 1] >> 63)) x |= f[k] & 1;
+      if (k + 1 < words && (s[k + 1] & 1)) x |= f[k] & (uint64_t(1) << 63);
+      x = fillUp(x, f[k]) | fillDown(x, f[k]);
+      if (x != s[k]) {
+        s[k] = x;
+        changed = true;
+      }
+    }
+  }
+}
+
+// fill the component of seed into comp (which is empty) and return the range of rows touched.
+void floodFillInto(const BitGrid& free, Point seed, BitGrid& comp, int& y0, int& y1) {
+  const int words = free.numWords();
+  y0 = y1 = seed.y;
+  comp.set(seed);
+  fillRow(comp.row(seed.y), free.row(seed.y), words);
+  std::vector<int> stack { seed.y };
+  while (!stack.empty()) {
+    const int y = stack.back();
+    stack.pop_back();
+    for (int ny : {y - 1, y + 1}) {
+      if (ny < 0 || free.height() <= ny) continue;
+      const uint64_t* c = comp.row(y);
+      const uint64_t* f = free.row(ny);
+      uint64_t* n = comp.row(ny);
+      bool grew = false;
+      for (int k = 0; k < words; ++k) {
+        const uint64_t add = c[k] & f[k] & ~n[k];
+        if (add) {
+          n[k] |= add;
+          grew = true;
+        }
+      }
+      if (grew) {
+        fillRow(n, f, words);
+        y0 = std::min(y0, ny);
+        y1 = std::max(y1, ny);
+        stack.push_back(ny);
+      }
+    }
+  }
+}
+
+} // namespace
+
+BitGrid::BitGrid(int W_, int H_)
+  : W(std::max(W_, 0)),
+    H(std::max(H_, 0)),
+    words((W + 63) / 64),
+    data(words * H, 0) {
+}
+
+BitGrid BitGrid::fromMask(const Map2D& map, int mask, int bits) {
+  BitGrid grid(map.W, map.H);
+  for (int y = 0; y < map.H; ++y) {
+    const int* cells = &map.data[y * map.W];
+    uint64_t* r = grid.row(y);
+    for (int k = 0; k < grid.words; ++k) {
+      const int n = std::min(64, map.W - k * 64);
+      uint64_t w = 0;
+      for (int i = 0; i < n; ++i) {
+        w |= uint64_t((cells[k * 64 + i] & mask) == bits) << i;
+      }
+      r[k] = w;
+    }
+  }
+  return grid;
+}
+
+int BitGrid::count() const {
+  int n = 0;
+  for (auto w : data) n += __builtin_popcountll(w);
+  return n;
+}
+
+bool BitGrid::empty() const {
+  return std::all_of(data.begin(), data.end(), [](uint64_t w) { return w == 0; });
+}
+
+std::vector<Point> BitGrid::points() const {
+  std::vector<Point> ps;
+  for (int y = 0; y < H; ++y) {
+    const uint64_t* r = row(y);
+    for (int k = 0; k < words; ++k) {
+      for (uint64_t w = r[k]; w; w &= w - 1) {
+        ps.push_back({k * 64 + __builtin_ctzll(w), y});
+      }
+    }
+  }
+  return ps;
+}
+
+void BitGrid::clear() {
+  std::fill(data.begin(), data.end(), 0);
+}
+
+BitGrid BitGrid::expand(const BitGrid& free) const {
+  BitGrid next(W, H);
+  expandInto(free, next, 0, H - 1);
+  return next;
+}
+
+void BitGrid::expandInto(const BitGrid& free, BitGrid& out, int y0, int y1) const {
+  assert (W == free.W && H == free.H && W == out.W && H == out.H);
+  for (int y = std::max(0, y0); y <= std::min(H - 1, y1); ++y) {
+    const uint64_t* c = row(y);
+    const uint64_t* f = free.row(y);
+    uint64_t* n = out.row(y);
+    for (int k = 0; k < words; ++k) {
+      uint64_t x = (c[k] << 1) | (c[k] >> 1);
+      if (k > 0) x |= c[k - 1] >> 63;
+      if (k + 1 < words) x |= c[k + 1] << 63;
+      if (y > 0) x |= row(y - 1)[k];
+      if (y + 1 < H) x |= row(y + 1)[k];
+      n[k] = x & f[k];
+    }
+  }
+}
+
+BitGrid floodFill(const BitGrid& free, Point seed) {
+  BitGrid comp(free.width(), free.height());
+  if (free.isInside(seed) && free.get(seed)) {
+    int y0, y1;
+    floodFillInto(free, seed, comp, y0, y1);
+  }
+  return comp;
+}
+
+std::vector<std::vector<Point>> connectedComponents(const BitGrid& free) {
+  const int words = free.numWords();
+  BitGrid rest(free);
+  BitGrid comp(free.width(), free.height());
+  std::vector<std::vector<Point>> components;
+  for (int y = 0; y < free.height(); ++y) {
+    for (int k = 0; k < words; ++k) {
+      while (rest.row(y)[k]) {
+        const Point seed(k * 64 + __builtin_ctzll(rest.row(y)[k]), y);
+        int y0, y1;
+        floodFillInto(rest, seed, comp, y0, y1);
+        std::vector<Point> component;
+        int n = 0;
+        for (int cy = y0; cy <= y1; ++cy) {
+          for (int ck = 0; ck < words; ++ck) n += __builtin_popcountll(comp.row(cy)[ck]);
+        }
+        component.reserve(n);
+        for (int cy = y0; cy <= y1; ++cy) {
+          uint64_t* c = comp.row(cy);
+          uint64_t* r = rest.row(cy);
+          for (int ck = 0; ck < words; ++ck) {
+            r[ck] &= ~c[ck];
+            for (uint64_t w = c[ck]; w; w &= w - 1) {
+              component.push_back({ck * 64 + __builtin_ctzll(w), cy});
+            }
+            c[ck] = 0;
+          }
+        }
+        components.push_back(std::move(component));
+      }
+    }
+  }
+  return components;
+}
+
+int bfsDistance(const BitGrid& free, Point start, const BitGrid& targets, int max_distance) {
+  return BitGridBFS(free).run(start, targets, max_distance);
+}
+
+BitGridBFS::BitGridBFS(const BitGrid& free_)
+  : free(free_), visited(free_.width(), free_.height()), next(free_.width(), free_.height()) {
+  for (auto& layer : layers) layer = BitGrid(free.width(), free.height());
+}
+
+int BitGridBFS::run(Point start, const BitGrid& targets, int max_distance) {
+  first_step = {0, 0};
+  if (!free.isInside(start) || !free.get(start)) return -1;
+  if (targets.get(start)) return 0;
+  const int words = free.numWords();
+  visited.clear();
+  visited.set(start);
+  for (int k = 0; k < 4; ++k) {
+    layers[k].clear();
+    const Point p = start + Point(all_directions[k]);
+    if (free.isInside(p) && free.get(p) && !visited.get(p)) {
+      layers[k].set(p);
+      visited.set(p);
+    }
+  }
+  next.clear();
+  // the layers have cells only in rows [y0, y1].
+  int y0 = std::max(0, start.y - 1), y1 = std::min(free.height() - 1, start.y + 1);
+  for (int d = 1; max_distance < 0 || d <= max_distance; ++d) {
+    // does the layer d hit a target? the smallest first step wins.
+    bool alive = false;
+    for (int k = 0; k < 4; ++k) {
+      for (int y = y0; y <= y1; ++y) {
+        const uint64_t* c = layers[k].row(y);
+        const uint64_t* t = targets.row(y);
+        for (int i = 0; i < words; ++i) {
+          alive |= c[i] != 0;
+          if (c[i] & t[i]) {
+            first_step = Point(all_directions[k]);
+            return d;
+          }
+        }
+      }
+    }
+    if (!alive) return -1;
+    y0 = std::max(0, y0 - 1);
+    y1 = std::min(free.height() - 1, y1 + 1);
+    for (auto& layer : layers) {
+      layer.expandInto(free, next, y0, y1);
+      for (int y = y0; y <= y1; ++y) {
+        uint64_t* n = next.row(y);
+        uint64_t* v = visited.row(y);
+        for (int i = 0; i < words; ++i) {
+          n[i] &= ~v[i];
+          v[i] |= n[i];
+        }
+      }
+      std::swap(layer, next);
+    }
+  }
+  return -1;
+}
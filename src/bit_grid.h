@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "base.h"
+#include "map2d.h"
+
+// binary image packed in 64-bit words. bit (x % 64) of word (x / 64) of row y is the cell (x, y).
+// flood fills and BFS layers are computed 64 cells at a time with shifts and ANDs.
+class BitGrid {
+public:
+  BitGrid() = default;
+  BitGrid(int W, int H);
+  // cells with (map(x, y) & mask) == bits.
+  static BitGrid fromMask(const Map2D& map, int mask, int bits);
+
+  int width() const { return W; }
+  int height() const { return H; }
+  int numWords() const { return words; } // per row.
+  uint64_t* row(int y) { return &data[y * words]; }
+  const uint64_t* row(int y) const { return &data[y * words]; }
+  bool isInside(Point p) const { return 0 <= p.x && p.x < W && 0 <= p.y && p.y < H; }
+  bool get(Point p) const { return (row(p.y)[p.x >> 6] >> (p.x & 63)) & 1; }
+  void set(Point p) { row(p.y)[p.x >> 6] |= uint64_t(1) << (p.x & 63); }
+  void reset(Point p) { row(p.y)[p.x >> 6] &= ~(uint64_t(1) << (p.x & 63)); }
+  void clear();
+
+  int count() const;
+  bool empty() const;
+  std::vector<Point> points() const; // in the raster order.
+
+  // cells in `free` which are 4-neighbors of this. (one BFS layer before excluding visited cells)
+  BitGrid expand(const BitGrid& free) const;
+  // same as expand() but only rows [y0, y1] of out are written. (cells of this must be in rows [y0 + 1, y1 - 1])
+  void expandInto(const BitGrid& free, BitGrid& out, int y0, int y1) const;
+
+private:
+  int W = 0;
+  int H = 0;
+  int words = 0;
+  std::vector<uint64_t> data;
+};
+
+// the 4-connected component of `free` containing seed. empty if seed is not in `free`.
+BitGrid floodFill(const BitGrid& free, Point seed);
+// the 4-connected components of `free` in the raster order of their first cells.
+// points of each component are in the raster order.
+std::vector<std::vector<Point>> connectedComponents(const BitGrid& free);
+// BFS distance from start to the nearest cell of targets through `free`. -1 if it is not reachable within max_distance.
+int bfsDistance(const BitGrid& free, Point start, const BitGrid& targets, int max_distance = -1);
+
+// BFS by layer masks which also gives the first move of a shortest path.
+// each layer is split by the first step from start, so no parent pointers are needed. among shortest paths the
+// first step earliest in all_directions is taken, same as a FIFO BFS scanning neighbors in all_directions order.
+// the buffers are reused by consecutive runs, and only the rows reached so far are expanded.
+class BitGridBFS {
+public:
+  explicit BitGridBFS(const BitGrid& free);
+  // distance from start to the nearest cell of targets. -1 if it is not reachable within max_distance.
+  int run(Point start, const BitGrid& targets, int max_distance = -1);
+  // the first move of the last run. {0, 0} if the distance was 0 or -1.
+  Point firstStep() const { return first_step; }
+
+private:
+  BitGrid free;
+  BitGrid visited;
+  std::array<BitGrid, 4> layers; // the current layer by the first step. (index of all_directions)
+  BitGrid next;
+  Point first_step;
+};
@@ -0,0 +1,54 @@
+#include "booster_index.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+constexpr int kIndexedBits =
+  CellType::kBoosterManipulatorBit |
+  CellType::kBoosterFastWheelBit |
+  CellType::kBoosterDrillBit |
+  CellType::kSpawnPointBit |
+  CellType::kBoosterTeleportBit |
+  CellType::kBoosterCloningBit |
+  CellType::kTeleportTargetBit;
+
+// raster order used by enumerateCellsByMask.
+bool rasterLess(const Point& lhs, const Point& rhs) {
+  return lhs.y != rhs.y ? lhs.y < rhs.y : lhs.x < rhs.x;
+}
+
+} // namespace
+
+int BoosterIndex::slot(int map_bit) {
+  assert (map_bit != 0 && (map_bit & (map_bit - 1)) == 0 && (map_bit & kIndexedBits) == map_bit);
+  return __builtin_ctz(map_bit);
+}
+
+void BoosterIndex::reset(const Map2D& map) {
+  for (auto& c : cells) c.clear();
+  for (int y = 0; y < map.H; ++y) {
+    for (int x = 0; x < map.W; ++x) {
+      const int bits = map(x, y) & kIndexedBits;
+      if (bits == 0) continue;
+      for (int i = 0; i < kNumBits; ++i) {
+        if (bits & (1 << i)) cells[i].emplace_back(x, y);
+      }
+    }
+  }
+}
+
+void BoosterIndex::add(int map_bit, Point p) {
+  auto& c = cells[slot(map_bit)];
+  auto it = std::lower_bound(c.begin(), c.end(), p, rasterLess);
+  if (it != c.end() && *it == p) return;
+  c.insert(it, p);
+}
+
+void BoosterIndex::remove(int map_bit, Point p) {
+  auto& c = cells[slot(map_bit)];
+  auto it = std::lower_bound(c.begin(), c.end(), p, rasterLess);
+  if (it == c.end() || *it != p) return;
+  c.erase(it);
+}
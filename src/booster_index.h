@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "base.h"
+#include "map2d.h"
+
+// positions of items on the map for each cell bit.
+// boosters (B, F, L, R, C), spawn points (X) and installed teleport targets are indexed.
+// Game keeps it in sync in pick(), Wrapper::useBooster() and Wrapper::undoAction().
+class BoosterIndex {
+public:
+  BoosterIndex() = default;
+  explicit BoosterIndex(const Map2D& map) { reset(map); }
+
+  // rebuild from the map.
+  void reset(const Map2D& map);
+
+  // both are idempotent. map_bit must be one of the indexed bits.
+  void add(int map_bit, Point p);
+  void remove(int map_bit, Point p);
+
+  // positions in the raster order, i.e. the same as enumerateCellsByMask(map, map_bit, map_bit).
+  const std::vector<Point>& positions(int map_bit) const { return cells[slot(map_bit)]; }
+  int count(int map_bit) const { return cells[slot(map_bit)].size(); }
+  bool empty(int map_bit) const { return cells[slot(map_bit)].empty(); }
+
+private:
+  static constexpr int kNumBits = 9; // kTeleportTargetBit is the highest.
+  static int slot(int map_bit);
+
+  std::array<std::vector<Point>, kNumBits> cells;
+};
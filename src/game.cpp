@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -15,6 +17,7 @@
 
 #include "fill_polygon.h"
 #include "manipulator_reach.h"
+#include "zobrist.h"
 
 Buy::Buy() {
   for (int i = 0; i < BoosterType::N; ++i) {
@@ -67,23 +70,24 @@ Game::Game() {
   }
 }
 
-Game::Game(const std::string& task) : Game() {
-  ParsedMap parsed = parseDescString(task);
-  map2d = parsed.map2d;
+Game::Game(const std::string& task) : Game(parseDescString(task)) {
+}
 
-  auto w = std::make_unique<Wrapper>(this, parsed.wrappy, 0);
-  pick(w->pos, nullptr);
-  paint(*w, nullptr);
-  wrappers.push_back(std::move(w));
+Game::Game(const std::vector<std::string>& mp) : Game(parseMapString(mp)) {
 }
 
-Game::Game(const std::vector<std::string>& mp) : Game() {
-  ParsedMap parsed = parseMapString(mp);
-  map2d = parsed.map2d;
+Game::Game(ParsedMap parsed) : Game() {
+  map2d = std::move(parsed.map2d);
+  unwrapped_pyramid.reset(map2d);
+  booster_index.reset(map2d);
+  obstacle_map.reset(map2d);
+  map_hash = zobrist::mapHash(map2d);
 
   auto w = std::make_unique<Wrapper>(this, parsed.wrappy, 0);
   pick(w->pos, nullptr);
   paint(*w, nullptr);
+  w->hash_key = zobrist::wrapperKey(*w);
+  wrapper_hash = w->hash_key;
   wrappers.push_back(std::move(w));
 }
 
@@ -95,6 +99,11 @@ Game& Game::operator=(const Game& rhs) {
   problem_no = rhs.problem_no;
   time = rhs.time;
   map2d = rhs.map2d;
+  unwrapped_pyramid = rhs.unwrapped_pyramid;
+  booster_index = rhs.booster_index;
+  obstacle_map = rhs.obstacle_map;
+  map_hash = rhs.map_hash;
+  wrapper_hash = rhs.wrapper_hash;
   num_boosters = rhs.num_boosters;
   debug_keyvalues = rhs.debug_keyvalues;
   wrappers.clear();
@@ -132,6 +141,8 @@ bool Game::tick() {
   ++time;
   // add new wrappers.
   for (auto&& w : next_wrappers) {
+    w->hash_key = zobrist::wrapperKey(*w);
+    wrapper_hash ^= w->hash_key;
     wrappers.push_back(std::move(w));
   }
   next_wrappers.clear();
@@ -149,6 +160,8 @@ void Game::pick(const Point& pos, Action* a_optional) {
       assert (booster.booster_type < num_boosters.size());
       ++num_boosters[booster.booster_type];
       map2d(pos) &= ~booster.map_bit;
+      map_hash ^= zobrist::cellKey(pos, booster.map_bit);
+      booster_index.remove(booster.map_bit, pos);
     }
   }
 }
@@ -162,20 +175,27 @@ void Game::paint(const Wrapper& w, Action* a_optional) {
   if ((map2d(p) & CellType::kWrappedBit) == 0) {
     if (map2d(p) & CellType::kObstacleBit) {
       map2d(p) &= ~CellType::kObstacleBit;
+      map_hash ^= zobrist::cellKey(p, CellType::kObstacleBit);
+      obstacle_map.set(p, false);
+      if (a_optional) a_optional->break_walls.push_back(p);
     } else {
       --map2d.num_unwrapped;
+      unwrapped_pyramid.set(p, false);
     }
     map2d(p) |= CellType::kWrappedBit;
+    map_hash ^= zobrist::cellKey(p, CellType::kWrappedBit);
     if (a_optional) a_optional->absolute_new_wrapped_positions.push_back(p);
   }
 
   // paint manipulator
-  for (auto manip : absolutePositionOfReachableManipulators(map2d, p, w.manipulators)) {
+  for (auto manip : absolutePositionOfReachableManipulators(obstacle_map, p, w.manipulators)) {
     // Manipulators can't drill obstacles.
     if ((map2d(manip) & kUnwrappedMask) == 0) {
       if (a_optional) a_optional->absolute_new_wrapped_positions.push_back(manip);
       map2d(manip) |= CellType::kWrappedBit;
+      map_hash ^= zobrist::cellKey(manip, CellType::kWrappedBit);
       --map2d.num_unwrapped;
+      unwrapped_pyramid.set(manip, false);
     }
   }
 }
@@ -188,6 +208,7 @@ bool Game::undo() {
     (*it)->undoAction();
     // unspawn.
     if ((*it)->actions.empty()) {
+      wrapper_hash ^= (*it)->hash_key;
       it = wrappers.erase(it);
     } else {
       ++it;
@@ -200,14 +221,41 @@ bool Game::undo() {
 }
 
 std::string Game::getCommand() const {
-  std::ostringstream oss;
+  size_t length = wrappers.size();
+  for (auto& w : wrappers) length += w->getCommand().size();
+  std::string command;
+  command.reserve(length);
   for (int i = 0; i < wrappers.size(); ++i) {
-    oss << wrappers[i]->getCommand();
+    command += wrappers[i]->getCommand();
     if (i + 1 < wrappers.size()) {
-      oss << '#';
+      command += '#';
     }
   }
-  return oss.str();
+  return command;
+}
+
+void Game::writeCommand(std::ostream& os) const {
+  for (int i = 0; i < wrappers.size(); ++i) {
+    const std::string& command = wrappers[i]->getCommand();
+    os.write(command.data(), command.size());
+    if (i + 1 < wrappers.size()) {
+      os.put('#');
+    }
+  }
+}
+
+uint64_t Game::hash() const {
+  uint64_t h = map_hash ^ wrapper_hash ^ zobrist::boostersKey(num_boosters);
+  for (auto& w : next_wrappers) h ^= zobrist::wrapperKey(*w);
+  return h;
+}
+
+uint64_t Game::computeHash() const {
+  uint64_t h = zobrist::mapHash(map2d) ^ zobrist::boostersKey(num_boosters);
+  for (auto* ws : {&wrappers, &next_wrappers}) {
+    for (auto& w : *ws) h ^= zobrist::wrapperKey(*w);
+  }
+  return h;
 }
 
 bool Game::isEnd() const {
@@ -222,11 +270,223 @@ std::vector<Point> Game::getWrapperPositions() const {
   return wrapper_positions;
 }
 
+namespace {
+
+const char kCheckpointMagic[8] = {'W', 'R', 'A', 'P', 'G', 'A', 'M', 'E'};
+constexpr uint32_t kCheckpointVersion = 1;
+// sanity limit for lengths in a checkpoint, to reject broken files before allocating.
+constexpr uint32_t kMaxCheckpointElements = 1 << 28;
+
+struct CheckpointWriter {
+  std::ostream& os;
+
+  template <typename T>
+  void pod(const T& v) { os.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+  void point(const Point& p) { pod<int32_t>(p.x); pod<int32_t>(p.y); }
+  void points(const std::vector<Point>& ps) {
+    pod<uint32_t>(ps.size());
+    for (auto& p : ps) point(p);
+  }
+  void str(const std::string& s) {
+    pod<uint32_t>(s.size());
+    os.write(s.data(), s.size());
+  }
+  void stat(const WrapperStat& st) {
+    pod<int32_t>(st.num_unwaped_move);
+    pod<int32_t>(st.time_spawn);
+    pod<int32_t>(st.time_last_unwrap);
+  }
+  void action(const Action& a) {
+    pod<int32_t>(a.timestamp);
+    stat(a.old_wrapper_stat);
+    stat(a.new_wrapper_stat);
+    point(a.old_position);
+    pod<uint8_t>(uint8_t(a.old_direction));
+    points(a.old_manipulator_offsets);
+    str(a.command);
+    point(a.new_position);
+    pod<uint8_t>(uint8_t(a.new_direction));
+    points(a.absolute_new_wrapped_positions);
+    points(a.new_manipulator_offsets);
+    points(a.break_walls);
+    for (int i = 0; i < BoosterType::N; ++i) {
+      points(a.pick_boosters[i]);
+      pod<int32_t>(a.use_booster[i]);
+    }
+    pod<uint8_t>(a.fast_wheels_active);
+    pod<uint8_t>(a.drill_active);
+    pod<int32_t>(a.spawned_index);
+  }
+  void wrapper(const Wrapper& w) {
+    pod<int32_t>(w.index);
+    point(w.pos);
+    pod<uint8_t>(uint8_t(w.direction));
+    points(w.manipulators);
+    pod<int32_t>(w.time_fast_wheels);
+    pod<int32_t>(w.time_drill);
+    stat(w.wrapper_stat);
+    pod<uint32_t>(w.actions.size());
+    for (auto& a : w.actions) action(a);
+  }
+};
+
+struct CheckpointReader {
+  std::istream& is;
+
+  template <typename T>
+  bool pod(T& v) { return bool(is.read(reinterpret_cast<char*>(&v), sizeof(T))); }
+  bool integer(int& v) {
+    int32_t x;
+    if (!pod(x)) return false;
+    v = x;
+    return true;
+  }
+  bool length(uint32_t& n) { return pod(n) && n < kMaxCheckpointElements; }
+  bool flag(bool& v) {
+    uint8_t x;
+    if (!pod(x) || x > 1) return false;
+    v = x;
+    return true;
+  }
+  bool direction(Direction& d) {
+    uint8_t x;
+    if (!pod(x) || x > uint8_t(Direction::D)) return false;
+    d = Direction(x);
+    return true;
+  }
+  bool point(Point& p) { return integer(p.x) && integer(p.y); }
+  bool points(std::vector<Point>& ps) {
+    uint32_t n;
+    if (!length(n)) return false;
+    ps.resize(n);
+    for (auto& p : ps) {
+      if (!point(p)) return false;
+    }
+    return true;
+  }
+  bool str(std::string& s) {
+    uint32_t n;
+    if (!length(n)) return false;
+    s.resize(n);
+    return n == 0 || bool(is.read(&s[0], n));
+  }
+  bool stat(WrapperStat& st) {
+    return integer(st.num_unwaped_move) && integer(st.time_spawn) && integer(st.time_last_unwrap);
+  }
+  bool action(Action& a) {
+    if (!integer(a.timestamp) || !stat(a.old_wrapper_stat) || !stat(a.new_wrapper_stat)) return false;
+    if (!point(a.old_position) || !direction(a.old_direction) || !points(a.old_manipulator_offsets)) return false;
+    if (!str(a.command) || !point(a.new_position) || !direction(a.new_direction)) return false;
+    if (!points(a.absolute_new_wrapped_positions) || !points(a.new_manipulator_offsets) || !points(a.break_walls)) return false;
+    for (int i = 0; i < BoosterType::N; ++i) {
+      if (!points(a.pick_boosters[i]) || !integer(a.use_booster[i])) return false;
+    }
+    return flag(a.fast_wheels_active) && flag(a.drill_active) && integer(a.spawned_index);
+  }
+  bool wrapper(Wrapper& w) {
+    if (!integer(w.index) || !point(w.pos) || !direction(w.direction) || !points(w.manipulators)) return false;
+    if (!integer(w.time_fast_wheels) || !integer(w.time_drill) || !stat(w.wrapper_stat)) return false;
+    uint32_t n;
+    if (!length(n)) return false;
+    w.actions.clear();
+    w.command_buffer.clear();
+    for (uint32_t i = 0; i < n; ++i) {
+      Action a(0, false, false, {}, Direction::W, {}, WrapperStat{});
+      if (!action(a)) return false;
+      w.command_buffer += a.command;
+      w.actions.push_back(std::move(a));
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+void Game::save(std::ostream& os) const {
+  CheckpointWriter writer {os};
+  os.write(kCheckpointMagic, sizeof(kCheckpointMagic));
+  writer.pod<uint32_t>(kCheckpointVersion);
+  writer.pod<int32_t>(problem_no);
+  writer.pod<int32_t>(time);
+  for (int i = 0; i < BoosterType::N; ++i) {
+    writer.pod<int32_t>(num_boosters[i]);
+  }
+  writer.pod<int32_t>(map2d.W);
+  writer.pod<int32_t>(map2d.H);
+  writer.pod<int32_t>(map2d.num_unwrapped);
+  for (auto cell : map2d.data) {
+    assert (0 <= cell && cell <= std::numeric_limits<uint16_t>::max());
+    writer.pod<uint16_t>(cell);
+  }
+  writer.pod<uint32_t>(wrappers.size());
+  for (auto& w : wrappers) writer.wrapper(*w);
+  writer.pod<uint32_t>(next_wrappers.size());
+  for (auto& w : next_wrappers) writer.wrapper(*w);
+}
+
+bool Game::saveToFile(const std::string& file_path) const {
+  const std::string tmp_path = file_path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::binary);
+    save(ofs);
+    if (!ofs.flush()) return false;
+  }
+  return std::rename(tmp_path.c_str(), file_path.c_str()) == 0;
+}
+
+std::unique_ptr<Game> Game::load(std::istream& is) {
+  CheckpointReader reader {is};
+  char magic[sizeof(kCheckpointMagic)];
+  uint32_t version;
+  if (!is.read(magic, sizeof(magic)) || std::memcmp(magic, kCheckpointMagic, sizeof(magic)) != 0) return nullptr;
+  if (!reader.pod(version) || version != kCheckpointVersion) return nullptr;
+
+  std::unique_ptr<Game> game(new Game());
+  if (!reader.integer(game->problem_no) || !reader.integer(game->time)) return nullptr;
+  for (int i = 0; i < BoosterType::N; ++i) {
+    if (!reader.integer(game->num_boosters[i])) return nullptr;
+  }
+  int W, H, num_unwrapped;
+  if (!reader.integer(W) || !reader.integer(H) || !reader.integer(num_unwrapped)) return nullptr;
+  if (W < 0 || H < 0 || uint64_t(W) * H >= kMaxCheckpointElements) return nullptr;
+  game->map2d = Map2D(W, H);
+  game->map2d.num_unwrapped = num_unwrapped;
+  for (auto& cell : game->map2d.data) {
+    uint16_t v;
+    if (!reader.pod(v)) return nullptr;
+    cell = v;
+  }
+  for (auto* ws : {&game->wrappers, &game->next_wrappers}) {
+    uint32_t n;
+    if (!reader.length(n)) return nullptr;
+    for (uint32_t i = 0; i < n; ++i) {
+      auto w = std::make_unique<Wrapper>(game.get(), Point(), 0);
+      if (!reader.wrapper(*w) || !game->map2d.isInside(w->pos)) return nullptr;
+      ws->push_back(std::move(w));
+    }
+  }
+  game->unwrapped_pyramid.reset(game->map2d);
+  game->booster_index.reset(game->map2d);
+  game->obstacle_map.reset(game->map2d);
+  game->map_hash = zobrist::mapHash(game->map2d);
+  for (auto& w : game->wrappers) {
+    w->hash_key = zobrist::wrapperKey(*w);
+    game->wrapper_hash ^= w->hash_key;
+  }
+  return game;
+}
+
+std::unique_ptr<Game> Game::loadFromFile(const std::string& file_path) {
+  std::ifstream ifs(file_path, std::ios::binary);
+  if (!ifs) return nullptr;
+  return load(ifs);
+}
+
 void Game::addClonedWrapperForNextFrame(std::unique_ptr<Wrapper> wrapper) { 
   next_wrappers.push_back(std::move(wrapper));
 }
 
-bool checkCommandString(std::string cmd) {
+bool checkCommandString(const std::string& cmd) {
   auto check_noexist = [&](std::string pattern) {
     if (cmd.find(pattern) != std::string::npos) {
       std::cerr << "Suspicious command: " << pattern << std::endl;
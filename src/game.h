@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <istream>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -10,6 +12,9 @@
 #include "map2d.h"
 #include "wrapper.h"
 #include "booster.h"
+#include "booster_index.h"
+#include "unwrapped_pyramid.h"
+#include "padded_obstacle_map.h"
 
 struct Buy {
   Buy();
@@ -24,6 +29,7 @@ struct Buy {
 struct Game {
   Game(const std::string& desc); // initialize using a task description string from *.desc file.
   Game(const std::vector<std::string>& map); // initialize by a raster *.map file.
+  explicit Game(ParsedMap parsed); // initialize by a parsed map. (e.g. from a dataset pack)
   Game(const Game& another);
   Game& operator=(const Game& another);
 
@@ -49,12 +55,26 @@ struct Game {
 
   int countUnwrapped() const { return map2d.num_unwrapped; }
 
+  // zobrist hash of the state between ticks: map cells, wrappers (including clones spawning in this frame)
+  // and unused boosters. time and action journals are not hashed, so the same state reached at different
+  // times has the same hash. computeHash() recomputes it from scratch. (for tests)
+  uint64_t hash() const;
+  uint64_t computeHash() const;
+
   std::string getCommand() const; // extended solution command.
+  void writeCommand(std::ostream& os) const; // same as os << getCommand(), without building the whole string.
 
   int nextWrapperIndex() const { return wrappers.size() + next_wrappers.size(); }
   void addClonedWrapperForNextFrame(std::unique_ptr<Wrapper> wrapper); // this wrapper will be available after tick()
   std::vector<Point> getWrapperPositions() const;
 
+  // binary checkpoint of the whole state: map, wrappers with their action journals, boosters and time.
+  // unwrapped_pyramid, booster_index and obstacle_map are rebuilt on load. (native byte order)
+  void save(std::ostream& os) const;
+  bool saveToFile(const std::string& file_path) const; // replaces the file atomically.
+  static std::unique_ptr<Game> load(std::istream& is); // nullptr if the stream is broken.
+  static std::unique_ptr<Game> loadFromFile(const std::string& file_path);
+
   // according to the rules, a tick consists of:
   // for i in [0..N]
   //   1. wrapper[i] picks anything in the cell
@@ -68,6 +88,16 @@ struct Game {
 
   // shared & updated map
   Map2D map2d;
+  // per-tile counts of unwrapped cells in map2d. updated together with map2d.
+  UnwrappedPyramid unwrapped_pyramid;
+  // positions of boosters, spawn points and teleport targets left in map2d.
+  BoosterIndex booster_index;
+  // obstacles in map2d with a sentinel border. updated together with map2d.
+  PaddedObstacleMap obstacle_map;
+  // zobrist::mapHash(map2d). updated together with map2d.
+  uint64_t map_hash = 0;
+  // XOR of wrappers[*]->hash_key. updated by Wrapper::doAction()/undoAction() and spawn/unspawn.
+  uint64_t wrapper_hash = 0;
 
   // State of Wrappy ===================================
   std::vector<std::unique_ptr<Wrapper>> wrappers;
@@ -82,7 +112,7 @@ private:
   friend std::ostream& operator<<(std::ostream&, const Game&);
 };
 
-bool checkCommandString(std::string);
+bool checkCommandString(const std::string&);
 
 std::vector<std::string> dumpMapStringWithManipulators(const Map2D& map2d, const std::vector<std::unique_ptr<Wrapper>>& wrappers);
 
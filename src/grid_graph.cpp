@@ -0,0 +1,130 @@
+#include "grid_graph.h"
+
+#include <algorithm>
+#include <cassert>
+
+void UnionFind::reset(int n) {
+  parent.resize(n);
+  for (int i = 0; i < n; ++i) parent[i] = i;
+  set_size.assign(n, 1);
+  num_sets = n;
+}
+
+bool UnionFind::unite(int a, int b) {
+  a = find(a);
+  b = find(b);
+  if (a == b) return false;
+  if (set_size[a] < set_size[b]) std::swap(a, b);
+  parent[b] = a;
+  set_size[a] += set_size[b];
+  --num_sets;
+  return true;
+}
+
+std::vector<WeightedEdge> minimumSpanningTree(const std::vector<WeightedEdge>& edges, int num_vertices) {
+  int max_cost = 0;
+  for (auto& e : edges) {
+    assert (e.cost >= 0);
+    max_cost = std::max(max_cost, e.cost);
+  }
+  // counting sort.
+  std::vector<int> begin(max_cost + 2, 0);
+  for (auto& e : edges) ++begin[e.cost + 1];
+  for (int c = 0; c <= max_cost; ++c) begin[c + 1] += begin[c];
+  std::vector<int> order(edges.size());
+  for (int i = 0; i < edges.size(); ++i) order[begin[edges[i].cost]++] = i;
+
+  std::vector<WeightedEdge> tree;
+  UnionFind uf(num_vertices);
+  for (int i : order) {
+    if (uf.unite(edges[i].from, edges[i].to)) {
+      tree.push_back(edges[i]);
+      if (uf.numSets() == 1) break;
+    }
+  }
+  return tree;
+}
+
+constexpr int GridDijkstra::kInfinity;
+
+GridDijkstra::GridDijkstra(int W_, int H_, int max_weight_)
+  : W(W_), H(H_), max_weight(max_weight_)
+  , weights(W_ * H_, 1), dist(W_ * H_, 0), stamp(W_ * H_, 0)
+  , buckets(max_weight_ + 1) {
+  assert (1 <= max_weight && max_weight < 256);
+}
+
+void GridDijkstra::setNeighborOrder(const std::array<Point, 4>& order) {
+  neighbor_order = order;
+}
+
+int GridDijkstra::run(int source_, int target) {
+  const int v = search(source_, target, nullptr);
+  if (target < 0) return 0;
+  return v < 0 ? kInfinity : dist[v];
+}
+
+int GridDijkstra::runToAny(int source_, const std::vector<uint8_t>& is_target) {
+  assert (is_target.size() == weights.size());
+  return search(source_, -1, &is_target);
+}
+
+int GridDijkstra::search(int source_, int target, const std::vector<uint8_t>* is_target) {
+  source = source_;
+  if (++current == 0) {
+    std::fill(stamp.begin(), stamp.end(), 0);
+    current = 1;
+  }
+  for (auto& b : buckets) b.clear();
+  const int num_buckets = buckets.size();
+  dist[source] = 0;
+  stamp[source] = current;
+  buckets[0].push_back(source);
+  int pending = 1;
+  for (int d = 0; pending > 0; ++d) {
+    auto& bucket = buckets[d % num_buckets];
+    // cells pushed to this bucket while it is scanned have larger distances. (weights >= 1)
+    for (int k = 0; k < bucket.size(); ++k) {
+      const int v = bucket[k];
+      --pending;
+      if (dist[v] != d) continue; // stale.
+      if (v == target || (is_target && (*is_target)[v])) return v;
+      const int x = v % W, y = v / W;
+      for (auto n : neighbor_order) {
+        if (x + n.x < 0 || x + n.x >= W || y + n.y < 0 || y + n.y >= H) continue;
+        const int u = v + n.y * W + n.x;
+        if (weights[u] == 0) continue;
+        const int nd = d + weights[u];
+        if (stamp[u] == current && dist[u] <= nd) continue;
+        stamp[u] = current;
+        dist[u] = nd;
+        buckets[nd % num_buckets].push_back(u);
+        ++pending;
+      }
+    }
+    bucket.clear();
+  }
+  return -1;
+}
+
+std::vector<int> GridDijkstra::path(int target) const {
+  if (source < 0 || distance(target) == kInfinity) return {};
+  std::vector<int> result = {target};
+  for (int v = target; v != source;) {
+    const int x = v % W, y = v / W;
+    int prev = -1;
+    for (auto n : neighbor_order) {
+      if (x + n.x < 0 || x + n.x >= W || y + n.y < 0 || y + n.y >= H) continue;
+      const int u = v + n.y * W + n.x;
+      if (distance(u) != kInfinity && distance(u) + weights[v] == dist[v]) {
+        prev = u;
+        break;
+      }
+    }
+    assert (prev >= 0);
+    result.push_back(prev);
+    v = prev;
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "base.h"
+
+// graph toolkit for the puzzle solvers.
+// grids have implicit 4-neighbor adjacency, and vertex v is the cell (v % W, v / W).
+
+// union-find over flat arrays. path halving and union by size.
+class UnionFind {
+public:
+  explicit UnionFind(int n = 0) { reset(n); }
+  void reset(int n);
+  int find(int x) {
+    while (parent[x] != x) {
+      parent[x] = parent[parent[x]];
+      x = parent[x];
+    }
+    return x;
+  }
+  bool unite(int a, int b); // false if they are already in the same set.
+  bool same(int a, int b) { return find(a) == find(b); }
+  int size(int x) { return set_size[find(x)]; }
+  int numSets() const { return num_sets; }
+
+private:
+  std::vector<int> parent;
+  std::vector<int> set_size;
+  int num_sets = 0;
+};
+
+struct WeightedEdge {
+  int from;
+  int to;
+  int cost; // small non-negative integer.
+};
+
+// minimum spanning forest by Kruskal. edges are bucket-sorted by cost, and equal costs keep the input order.
+std::vector<WeightedEdge> minimumSpanningTree(const std::vector<WeightedEdge>& edges, int num_vertices);
+
+// Dial's algorithm on a W x H grid. entering cell v costs weight(v) in [1, max_weight], and weight 0 blocks it.
+// distances are stamped per run, so the buffers are reused without clearing.
+class GridDijkstra {
+public:
+  static constexpr int kInfinity = INT_MAX;
+
+  GridDijkstra(int W, int H, int max_weight = 1);
+  int index(Point p) const { return p.y * W + p.x; }
+  Point point(int v) const { return {v % W, v / W}; }
+  int weight(int v) const { return weights[v]; }
+  void setWeight(int v, int w) { weights[v] = w; }
+  // neighbors are scanned in this order. the default {-y, -x, +x, +y} is the ascending index order.
+  void setNeighborOrder(const std::array<Point, 4>& order);
+
+  // stops when target is settled. all reachable cells are settled if target < 0.
+  // returns the distance of target. (kInfinity if it is not reachable, 0 if target < 0)
+  int run(int source, int target = -1);
+  // stops when the first cell with is_target[v] != 0 is settled, and returns it. (-1 if none is reachable)
+  // with unit weights it is the first target found by a BFS scanning neighbors in the same order.
+  int runToAny(int source, const std::vector<uint8_t>& is_target);
+  int distance(int v) const { return stamp[v] == current ? dist[v] : kInfinity; }
+  // [source, ..., target] of the last run. empty if target is not reached.
+  // the predecessor of a cell is its first neighbor on a shortest path in the neighbor order. with the default
+  // order it is the lowest-index one, same as a binary-heap Dijkstra popping (distance, index) pairs.
+  std::vector<int> path(int target) const;
+
+private:
+  // returns the settled cell which stopped the search, or -1.
+  int search(int source, int target, const std::vector<uint8_t>* is_target);
+
+  int W;
+  int H;
+  int max_weight;
+  std::array<Point, 4> neighbor_order = {{{0, -1}, {-1, 0}, {1, 0}, {0, 1}}};
+  int source = -1;
+  std::vector<uint8_t> weights;
+  std::vector<int> dist;
+  std::vector<uint32_t> stamp;
+  uint32_t current = 0;
+  std::vector<std::vector<int>> buckets; // circular. distance d is in buckets[d % (max_weight + 1)].
+};
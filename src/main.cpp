@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <iostream>
@@ -13,6 +14,14 @@
 #include "puzzle.h"
 #include "fill_polygon.h"
 #include "solver_registry.h"
+#include "solver_helper.h"
+#include "solution.h"
+#include "solution_optimizer.h"
+#include "splice.h"
+#include "serve.h"
+#include "mine.h"
+#include "pack.h"
+#include "puzzle_search.h"
 
 int parseProblemNumber(std::string desc_or_map_file_path) {
   std::regex re(R"(prob-(\d{3}))");
@@ -43,6 +52,27 @@ std::string resolveDescPath(std::string desc_path_hint) {
   return desc_path_hint;
 }
 
+// boosters to buy from --buy (a directory of <stem>.buy files) or --buy-str.
+Buy loadBuy(const std::string& stem, const std::string& buy_database_dir, const std::string& buy_str) {
+  assert (buy_database_dir.empty() || buy_str.empty()); // mutially exclusive options.
+  Buy buy;
+  if (!stem.empty() && std::experimental::filesystem::is_directory(buy_database_dir)) {
+    // read buy file.
+    std::string buy_path = buy_database_dir + "/" + stem + ".buy";
+    if (!std::experimental::filesystem::is_regular_file(buy_path)) {
+      std::cerr << "**** no buy file [" << buy_path << "] for " << stem << std::endl;
+    } else {
+      std::cerr << "**** use buy file [" << buy_path << "] for " << stem << std::endl;
+      buy = Buy::fromFile(buy_path);
+    }
+  }
+  if (!buy_str.empty()) {
+    std::cerr << "**** use buy str [" << buy_str << "]" << std::endl;
+    buy = Buy(buy_str);
+  }
+  return buy;
+}
+
 const std::string& toString(const std::string& s) {
   return s;
 }
@@ -80,12 +110,78 @@ int main(int argc, char* argv[]) {
   sub_run->add_option("--buy", buy_database_dir, "use a buy directory");
   sub_run->add_option("--buy-str", buy_str, "buy string. e.g.) BBBRRLFC");
   sub_run->add_option("--wait-ms", solver_param.wait_ms, "display and pause a while between frames");
+  sub_run->add_option("--time-limit", solver_param.time_limit_s, "time limit in seconds for restarting engines");
+  sub_run->add_option("--deadline", solver_param.deadline, "deadline in seconds since the epoch for restarting engines");
+  sub_run->add_option("--restarts", solver_param.num_restarts, "run the engine N times with different seeds and keep the best");
+  sub_run->add_option("--threads", solver_param.num_threads, "# of concurrent restarts (0: all cores)");
+  sub_run->add_option("--seed", solver_param.seed, "random seed of the first restart");
+  sub_run->add_flag("--allocate-pairs-first", solver_param.allocate_pairs_first, "assign C to the nearest (wrapper, C) pairs first in clone engines");
+  std::string pack_filename;
+  sub_run->add_option("--pack", pack_filename, "read the problem from a dataset pack made by `solver pack`");
+  int checkpoint_every = 0;
+  std::string checkpoint_filename;
+  std::string resume_filename;
+  sub_run->add_option("--checkpoint-every", checkpoint_every, "save a checkpoint every N time steps");
+  sub_run->add_option("--checkpoint", checkpoint_filename, "checkpoint file. (default: <output or stem>.ckpt)");
+  sub_run->add_option("--resume", resume_filename, "resume from a checkpoint file");
+
+  auto sub_pack = app.add_subcommand("pack", "pack parsed *.desc files into one binary file");
+  std::vector<std::string> pack_desc_filenames;
+  std::string pack_output_filename = "../dataset/problems.pack";
+  sub_pack->add_option("desc_files", pack_desc_filenames, "*.desc files (default: ../dataset/problems/*.desc)");
+  sub_pack->add_option("--output", pack_output_filename, "output pack file");
 
   auto sub_check_command = app.add_subcommand("check_command");
   std::string solution_filename;
+  std::string cond_filename;
   sub_check_command->add_option("solution_file", solution_filename, "input .sol file");
 
-  std::string cond_filename;
+  auto sub_optimize = app.add_subcommand("optimize", "replay a *.sol file and shorten it");
+  OptimizerParam optimizer_param;
+  sub_optimize->add_option("solution_file", solution_filename, "input .sol file");
+  sub_optimize->add_option("--desc", desc_filename, "*.desc file input");
+  sub_optimize->add_option("--map", map_filename, "*.map file input");
+  sub_optimize->add_option("--buy", buy_database_dir, "use a buy directory");
+  sub_optimize->add_option("--buy-str", buy_str, "buy string. e.g.) BBBRRLFC");
+  sub_optimize->add_option("--output", command_output_filename, "output the optimized commands to a file");
+  sub_optimize->add_option("--window", optimizer_param.window, "max # of commands re-planned at once");
+  sub_optimize->add_option("--threads", optimizer_param.num_threads, "# of threads (0: all cores)");
+  sub_optimize->add_option("--time-limit", optimizer_param.time_limit_s, "time limit in seconds");
+  sub_optimize->add_flag("--verbose", optimizer_param.verbose, "print progress");
+
+  auto sub_splice = app.add_subcommand("splice", "continue prefixes of solutions with other engines");
+  std::vector<std::string> splice_solution_filenames;
+  SpliceParam splice_param;
+  sub_splice->add_option("solution_files", splice_solution_filenames, "input .sol files");
+  sub_splice->add_option("--desc", desc_filename, "*.desc file input");
+  sub_splice->add_option("--buy", buy_database_dir, "use a buy directory");
+  sub_splice->add_option("--buy-str", buy_str, "buy string. e.g.) BBBRRLFC");
+  sub_splice->add_option("--output", command_output_filename, "output the best commands to a file");
+  sub_splice->add_option("--engines", splice_param.engines, "engines to continue with (default: ../engine_names.txt)");
+  sub_splice->add_option("--fractions", splice_param.fractions, "extra checkpoints. e.g.) 0.25 0.5");
+  sub_splice->add_option("--threads", splice_param.num_threads, "# of threads (0: all cores)");
+  sub_splice->add_flag("--verbose", splice_param.verbose, "print the result of every run");
+
+  auto sub_serve = app.add_subcommand("serve", "solve JSON-lines jobs from stdin or a Unix socket");
+  std::string serve_socket_path;
+  int serve_threads = 0;
+  sub_serve->add_option("--socket", serve_socket_path, "listen on a Unix domain socket instead of stdin");
+  sub_serve->add_option("--threads", serve_threads, "# of worker threads (0: all cores)");
+
+  auto sub_mine = app.add_subcommand("mine", "solve the puzzle and the task of a block at once");
+  std::string block_dir;
+  std::string mine_output_dir = ".";
+  MineParam mine_param;
+  mine_param.solver_param.time_limit_s = 400;
+  sub_mine->add_option("--block", block_dir, "block directory with puzzle.cond and task.desc");
+  sub_mine->add_option("--cond", cond_filename, "*.cond file input (default: <block>/puzzle.cond)");
+  sub_mine->add_option("--desc", desc_filename, "*.desc file input (default: <block>/task.desc)");
+  sub_mine->add_option("--output-dir", mine_output_dir, "write task.sol and puzzle.desc here");
+  sub_mine->add_option("--puzzle-solver", mine_param.puzzle_solver, "the puzzle solver name");
+  sub_mine->add_option("--engines", mine_param.engines, "task engines (default: ../mining_engine_names.txt)");
+  sub_mine->add_option("--time-limit", mine_param.solver_param.time_limit_s, "time limit in seconds for the task engines");
+  sub_mine->add_option("--threads", mine_param.num_threads, "# of concurrent engines (0: all cores)");
+  sub_mine->add_flag("--verbose", mine_param.verbose, "print the result of every run");
 
   auto sub_puzzle_convert = app.add_subcommand("puzzle_convert", "read *.cond file and print pmap format");
   sub_puzzle_convert->add_option("input_cond", cond_filename, "*.cond file input");
@@ -98,6 +194,14 @@ int main(int argc, char* argv[]) {
   sub_puzzle_run->add_option("--output", command_output_filename, "output commands to a file");
   sub_puzzle_run->add_option("--meta", meta_output_filename, "output meta information to a JSON file");
   sub_puzzle_run->add_flag("--validate", puzzle_validation, "validate puzzle solution");
+  PuzzleSearchParam puzzle_search_param;
+  puzzle_search_param.num_candidates = 1;
+  double puzzle_time_limit_s = 0;
+  sub_puzzle_run->add_option("--seed", puzzle_solver_param.seed, "random seed of the solver (the first candidate)");
+  sub_puzzle_run->add_option("--candidates", puzzle_search_param.num_candidates, "# of seeds to try. the hardest valid one is output");
+  sub_puzzle_run->add_option("--threads", puzzle_search_param.num_threads, "# of concurrent candidates (0: all cores)");
+  sub_puzzle_run->add_option("--time-limit", puzzle_time_limit_s, "no candidate is started after this (seconds)");
+  sub_puzzle_run->add_option("--score-engine", puzzle_search_param.score_engine, "engine to measure the hardness of candidates");
 
   CLI11_PARSE(app, argc, argv);
 
@@ -131,7 +235,31 @@ int main(int argc, char* argv[]) {
     std::unique_ptr<Game> game; 
     desc_filename = resolveDescPath(desc_filename);
     int problem_no = -1;
-    if (std::experimental::filesystem::is_regular_file(desc_filename)) {
+    if (!resume_filename.empty()) {
+      std::cerr << "Resume: " << resume_filename << "\n";
+      stem = toString(std::experimental::filesystem::path(resume_filename).stem());
+      game = Game::loadFromFile(resume_filename);
+      if (!game) {
+        std::cerr << "failed to load checkpoint " << resume_filename << std::endl;
+        return 1;
+      }
+      problem_no = game->problem_no;
+    } else if (!pack_filename.empty()) {
+      std::unique_ptr<DatasetPack> pack = DatasetPack::open(pack_filename);
+      stem = toString(std::experimental::filesystem::path(desc_filename).stem());
+      int index = pack ? pack->find(stem) : -1;
+      if (pack && index < 0) {
+        stem = "prob-" + stem; // e.g.) --desc 001
+        index = pack->find(stem);
+      }
+      if (index < 0) {
+        std::cerr << "failed to find " << stem << " in " << pack_filename << std::endl;
+        return 1;
+      }
+      std::cerr << "Input: " << stem << " in " << pack_filename << "\n";
+      problem_no = parseProblemNumber(stem);
+      game = pack->makeGame(index);
+    } else if (std::experimental::filesystem::is_regular_file(desc_filename)) {
       std::cerr << "Input: " << desc_filename << "\n";
       problem_no = parseProblemNumber(desc_filename);
       stem = toString(std::experimental::filesystem::path(desc_filename).stem());
@@ -159,30 +287,43 @@ int main(int argc, char* argv[]) {
     }
     game->problem_no = problem_no;
 
-    assert (buy_database_dir.empty() || buy_str.empty()); // mutially exclusive options.
     Buy buy;
-    if (!stem.empty() && std::experimental::filesystem::is_directory(buy_database_dir)) {
-      // read buy file.
-      std::string buy_path = buy_database_dir + "/" + stem + ".buy";
-      if (!std::experimental::filesystem::is_regular_file(buy_path)) {
-        std::cerr << "**** no buy file [" << buy_path << "] for " << stem << std::endl;
-      } else {
-        std::cerr << "**** use buy file [" << buy_path << "] for " << stem << std::endl;
-        buy = Buy::fromFile(buy_path);
-      }
-    }
-    if (!buy_str.empty()) {
-      std::cerr << "**** use buy str [" << buy_str << "]" << std::endl;
-      buy = Buy(buy_str);
+    if (resume_filename.empty()) {
+      // bought boosters are already in the checkpoint.
+      buy = loadBuy(stem, buy_database_dir, buy_str);
     }
     if (!buy.empty()) {
       game->buyBoosters(buy);
     }
 
+    SolverIterCallback iter_callback = [](Game*) { return true; };
+    if (checkpoint_every > 0) {
+      if (checkpoint_filename.empty()) {
+        checkpoint_filename = (command_output_filename.empty() ? (stem.empty() ? std::string("game") : stem) : command_output_filename) + ".ckpt";
+      }
+      std::cerr << "**** checkpoint every " << checkpoint_every << " steps to [" << checkpoint_filename << "]" << std::endl;
+      iter_callback = [&](Game* g) {
+        if (g->time % checkpoint_every == 0 && !g->saveToFile(checkpoint_filename)) {
+          std::cerr << "failed to save checkpoint " << checkpoint_filename << std::endl;
+        }
+        return true;
+      };
+    }
+
     // solve the task.
     const auto t0 = std::chrono::system_clock::now();
+    if (solver_param.time_limit_s > 0) {
+      const double limit = std::chrono::duration<double>(t0.time_since_epoch()).count() + solver_param.time_limit_s;
+      solver_param.deadline = solver_param.hasDeadline() ? std::min(solver_param.deadline, limit) : limit;
+    }
     if (SolverFunction solver = SolverRegistry<SolverFunction>::getSolver(solver_name)) {
-      solver(solver_param, game.get(), [](Game*) { return true; });
+      if (solver_param.num_restarts > 0) {
+        // any engine can be restarted. engines which restart by themselves run once in each restart.
+        restartSolver(solver_param, game.get(), iter_callback, solver_param.num_restarts,
+          [&](SolverParam param, Game* g, SolverIterCallback callback, int) { return solver(param, g, callback); });
+      } else {
+        solver(solver_param, game.get(), iter_callback);
+      }
       if (!game->isEnd()) {
         std::cerr << "******** Some cells are not wrapped **********\n"
                   << *game << "\n";
@@ -192,7 +333,9 @@ int main(int argc, char* argv[]) {
     const double solve_s = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() * 1e-6;
 
     // check suspicous commands.
-    checkCommandString(game->getCommand());
+    for (auto& w : game->wrappers) {
+      checkCommandString(w->getCommand());
+    }
 
     // command output
     if (!command_output_filename.empty()) {
@@ -200,7 +343,7 @@ int main(int argc, char* argv[]) {
       // if (!buy.empty()) { // to distinguish from non-buy solutions.
       //   ofs << "buy:" << buy.toString() << "\n";
       // }
-      ofs << game->getCommand();
+      game->writeCommand(ofs);
     }
     // meta information output
     if (!meta_output_filename.empty() && game->isEnd()) {
@@ -248,6 +391,189 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  // ================== optimize
+  if (sub_optimize->parsed()) {
+    desc_filename = resolveDescPath(desc_filename);
+    std::string stem;
+    std::unique_ptr<Game> game;
+    if (std::experimental::filesystem::is_regular_file(desc_filename)) {
+      stem = toString(std::experimental::filesystem::path(desc_filename).stem());
+      std::ifstream ifs(desc_filename);
+      std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+      game.reset(new Game(str));
+    } else if (std::experimental::filesystem::is_regular_file(map_filename)) {
+      stem = toString(std::experimental::filesystem::path(map_filename).stem());
+      std::ifstream ifs(map_filename);
+      std::vector<std::string> input;
+      for (std::string l; std::getline(ifs, l);)
+        input.emplace_back(l);
+      game.reset(new Game(input));
+    } else {
+      std::cerr << "optimize needs --desc or --map" << std::endl;
+      return 1;
+    }
+    Buy buy = loadBuy(stem, buy_database_dir, buy_str);
+    if (!buy.empty()) {
+      game->buyBoosters(buy);
+    }
+
+    assert (std::experimental::filesystem::is_regular_file(solution_filename));
+    std::ifstream ifs(solution_filename);
+    std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    const SolutionCommands input = parseSolutionString(str);
+
+    const auto t0 = std::chrono::system_clock::now();
+    const SolutionCommands optimized = optimizeSolution(*game, input, optimizer_param);
+    const auto t1 = std::chrono::system_clock::now();
+    const double solve_s = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() * 1e-6;
+
+    Game before(*game);
+    Game after(*game);
+    const bool input_ok = replaySolution(&before, input) && before.isEnd();
+    const bool output_ok = replaySolution(&after, optimized) && after.isEnd();
+    if (!input_ok || !output_ok) {
+      std::cerr << "[X] the " << (input_ok ? "optimized" : "input") << " solution is not valid." << std::endl;
+      return 1;
+    }
+    if (!command_output_filename.empty()) {
+      std::ofstream ofs(command_output_filename);
+      ofs << solutionToString(optimized);
+    }
+    std::cout << "Time step: " << before.time << " -> " << after.time << "\n";
+    std::cout << "Elapsed  : " << solve_s << " s\n";
+  }
+
+  // ================== splice
+  if (sub_splice->parsed()) {
+    desc_filename = resolveDescPath(desc_filename);
+    assert (std::experimental::filesystem::is_regular_file(desc_filename));
+    const std::string stem = toString(std::experimental::filesystem::path(desc_filename).stem());
+    std::ifstream ifs(desc_filename);
+    std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    Game game(str);
+    game.problem_no = parseProblemNumber(desc_filename);
+    Buy buy = loadBuy(stem, buy_database_dir, buy_str);
+    if (!buy.empty()) {
+      game.buyBoosters(buy);
+    }
+
+    if (splice_param.engines.empty()) {
+      std::ifstream ifs("../engine_names.txt");
+      for (std::string name; std::getline(ifs, name);) {
+        if (SolverRegistry<SolverFunction>::getRegistry().count(name)) splice_param.engines.push_back(name);
+      }
+    }
+    std::vector<SpliceCandidate> candidates;
+    for (auto& filename : splice_solution_filenames) {
+      std::ifstream ifs(filename);
+      std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+      candidates.push_back({toString(std::experimental::filesystem::path(filename).filename()), parseSolutionString(str)});
+    }
+
+    const auto t0 = std::chrono::system_clock::now();
+    SpliceResult result = spliceSolutions(game, candidates, splice_param);
+    const auto t1 = std::chrono::system_clock::now();
+    const double solve_s = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() * 1e-6;
+    if (!result.valid) {
+      std::cerr << "[X] no valid solution." << std::endl;
+      return 1;
+    }
+    if (!command_output_filename.empty()) {
+      std::ofstream ofs(command_output_filename);
+      ofs << result.command;
+    }
+    std::cout << "Best     : " << result.description << "\n";
+    std::cout << "Time step: " << result.time << "\n";
+    std::cout << "Elapsed  : " << solve_s << " s\n";
+  }
+
+  // ================== serve
+  if (sub_serve->parsed()) {
+    // engines print logs to std::cout. keep stdout for results.
+    std::ostream results(std::cout.rdbuf());
+    std::cout.rdbuf(std::cerr.rdbuf());
+    if (!serve_socket_path.empty()) {
+      if (!serveUnixSocket(serve_socket_path, serve_threads)) {
+        std::cerr << "failed to listen on " << serve_socket_path << std::endl;
+        return_code = 1;
+      }
+    } else {
+      serveStream(std::cin, results, serve_threads);
+    }
+    std::cout.rdbuf(results.rdbuf());
+  }
+
+  // ================== pack
+  if (sub_pack->parsed()) {
+    namespace fs = std::experimental::filesystem;
+    if (pack_desc_filenames.empty()) {
+      for (auto& entry : fs::directory_iterator("../dataset/problems")) {
+        if (entry.path().extension() == ".desc") pack_desc_filenames.push_back(toString(entry.path()));
+      }
+      std::sort(pack_desc_filenames.begin(), pack_desc_filenames.end());
+    }
+    std::vector<std::pair<std::string, std::string>> named_descs;
+    for (auto& filename : pack_desc_filenames) {
+      std::ifstream ifs(filename);
+      std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+      named_descs.emplace_back(toString(fs::path(filename).stem()), str);
+    }
+    if (!writeDatasetPack(named_descs, pack_output_filename)) {
+      std::cerr << "[X] failed to write " << pack_output_filename << std::endl;
+      return 1;
+    }
+    std::cout << named_descs.size() << " problems => " << pack_output_filename << "\n";
+  }
+
+  // ================== mine
+  if (sub_mine->parsed()) {
+    namespace fs = std::experimental::filesystem;
+    if (cond_filename.empty()) cond_filename = toString(fs::path(block_dir) / "puzzle.cond");
+    if (desc_filename.empty()) desc_filename = toString(fs::path(block_dir) / "task.desc");
+    if (!fs::is_regular_file(cond_filename) || !fs::is_regular_file(desc_filename)) {
+      std::cerr << "[X] " << cond_filename << " or " << desc_filename << " is not found." << std::endl;
+      return 1;
+    }
+    std::ifstream cond_ifs(cond_filename);
+    Puzzle puzzle = parsePuzzleCondString(std::string((std::istreambuf_iterator<char>(cond_ifs)), std::istreambuf_iterator<char>()));
+    std::ifstream desc_ifs(desc_filename);
+    Game task(std::string((std::istreambuf_iterator<char>(desc_ifs)), std::istreambuf_iterator<char>()));
+
+    if (mine_param.engines.empty()) {
+      std::ifstream ifs("../mining_engine_names.txt");
+      for (std::string name; std::getline(ifs, name);) {
+        if (name.empty() || name[0] == '#') continue;
+        if (SolverRegistry<SolverFunction>::getRegistry().count(name)) mine_param.engines.push_back(name);
+      }
+    }
+
+    const auto t0 = std::chrono::system_clock::now();
+    if (mine_param.solver_param.time_limit_s > 0) {
+      mine_param.solver_param.deadline = std::chrono::duration<double>(t0.time_since_epoch()).count() + mine_param.solver_param.time_limit_s;
+    }
+    // engines print logs to std::cout.
+    std::streambuf* cout_buf = std::cout.rdbuf(std::cerr.rdbuf());
+    MineResult result = mineBlock(puzzle, task, mine_param);
+    std::cout.rdbuf(cout_buf);
+    const auto t1 = std::chrono::system_clock::now();
+    const double solve_s = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() * 1e-6;
+
+    fs::create_directories(mine_output_dir);
+    if (result.puzzle_valid) {
+      std::ofstream ofs(toString(fs::path(mine_output_dir) / "puzzle.desc"));
+      ofs << result.puzzle_solution.toString();
+    }
+    if (result.task_valid) {
+      std::ofstream ofs(toString(fs::path(mine_output_dir) / "task.sol"));
+      ofs << result.task_command;
+    }
+    std::cout << "Puzzle   : " << (result.puzzle_valid ? "valid" : "invalid") << "\n";
+    std::cout << "Task     : " << (result.task_valid ? result.task_engine : std::string("invalid")) << "\n";
+    std::cout << "Time step: " << result.task_time << "\n";
+    std::cout << "Elapsed  : " << solve_s << " s\n";
+    if (!result.puzzle_valid || !result.task_valid) return_code = 1;
+  }
+
   // ================== puzzle_convert
   if (sub_puzzle_convert->parsed()) {
     assert (std::experimental::filesystem::is_regular_file(cond_filename));
@@ -269,7 +595,22 @@ int main(int argc, char* argv[]) {
     // solve
     PuzzleSolution puzzle_solution;
     const auto t0 = std::chrono::system_clock::now();
-    if (PuzzleSolverFunction solver = SolverRegistry<PuzzleSolverFunction>::getSolver(solver_name)) {
+    if (puzzle_search_param.num_candidates > 1) {
+      puzzle_search_param.solvers = {solver_name};
+      puzzle_search_param.seed = puzzle_solver_param.seed;
+      if (puzzle_time_limit_s > 0) {
+        puzzle_search_param.deadline = std::chrono::duration<double>(t0.time_since_epoch()).count() + puzzle_time_limit_s;
+      }
+      puzzle_search_param.verbose = true;
+      // engines print logs to std::cout.
+      std::streambuf* cout_buf = std::cout.rdbuf(std::cerr.rdbuf());
+      PuzzleSearchResult result = searchPuzzle(puzzle, puzzle_search_param);
+      std::cout.rdbuf(cout_buf);
+      std::cerr << result.num_valid << "/" << result.num_candidates << " valid candidates. best: seed=" << result.seed
+                << " score=" << result.score << std::endl;
+      puzzle_solution = result.solution;
+      return_code = result.valid ? 0 : 1;
+    } else if (PuzzleSolverFunction solver = SolverRegistry<PuzzleSolverFunction>::getSolver(solver_name)) {
       puzzle_solution = solver(puzzle_solver_param, puzzle);
 
       if (puzzle_validation) {
@@ -54,3 +54,24 @@ std::vector<Point> absolutePositionOfReachableManipulators(
   
   return reachables;
 }
+
+std::vector<Point> absolutePositionOfReachableManipulators(
+  const PaddedObstacleMap& obstacles, Point wrappy_pos, const std::vector<Point>& relative_manipulator_offsets) {
+
+  std::vector<Point> reachables;
+  for (auto& manipulator : relative_manipulator_offsets) {
+    const bool padded = std::max(std::abs(manipulator.x), std::abs(manipulator.y)) <= PaddedObstacleMap::kPadding;
+    bool blocked = false;
+    for (auto& p : requiredClearance(manipulator)) {
+      auto test_pos = wrappy_pos + p;
+      if ((!padded && !obstacles.isInside(test_pos)) || !obstacles.isFree(test_pos)) {
+        blocked = true;
+        break;
+      }
+    }
+    if (!blocked) {
+      reachables.push_back(wrappy_pos + manipulator);
+    }
+  }
+  return reachables;
+}
@@ -2,6 +2,7 @@
 #include <vector>
 #include "base.h"
 #include "map2d.h"
+#include "padded_obstacle_map.h"
 
 std::vector<Point> requiredClearance(Point offset);
 
@@ -9,3 +10,6 @@ std::vector<Point> requiredClearance(Point offset);
 // result: absolute position.
 std::vector<Point> absolutePositionOfReachableManipulators(
   const Map2D& map2d, Point wrappy_pos, const std::vector<Point>& relative_manipulator_offsets);
+// same as above. arms up to PaddedObstacleMap::kPadding cells need no bounds checks.
+std::vector<Point> absolutePositionOfReachableManipulators(
+  const PaddedObstacleMap& obstacles, Point wrappy_pos, const std::vector<Point>& relative_manipulator_offsets);
@@ -8,6 +8,8 @@
 #include <queue>
 #include <limits>
 #include <cassert>
+#include <cctype>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
@@ -96,51 +98,61 @@ std::vector<Point> shortestPathByMaskBFS(const Map2D& map,
   constexpr int FOREGROUND = 1;
   constexpr int TARGET = 2;
   constexpr int VISITED = 4;
-  Map2D work(map.W, map.H, 0);
+  // work cells with a border of background cells, so that neighbors need no bounds checks. (linear index)
+  const int stride = map.W + 2;
+  auto index = [&](Point p) { return (p.y + 1) * stride + (p.x + 1); };
+  auto point = [&](int i) { return Point(i % stride - 1, i / stride - 1); };
+  std::vector<uint8_t> work(stride * (map.H + 2), 0);
   for (int y = 0; y < map.H; ++y) {
+    uint8_t* row = &work[index({0, y})];
     for (int x = 0; x < map.W; ++x) {
       if ((map(x, y) & free_mask) == free_bits) {
-        work(x, y) |= FOREGROUND;
+        row[x] |= FOREGROUND;
       }
       if ((map(x, y) & target_mask) == target_bits) {
-        work(x, y) |= FOREGROUND | TARGET;
+        row[x] |= FOREGROUND | TARGET;
       }
     }
   }
+  int neighbor_offsets[4];
+  for (int k = 0; k < 4; ++k) {
+    const Point d(all_directions[k]);
+    neighbor_offsets[k] = d.y * stride + d.x;
+  }
 
-  Map2D distance(map.W, map.H, -1);
-  std::vector<Point> _parent(map.W * map.H, {-9, -9});
-  auto parent = [&](Point p) -> Point& { return _parent[p.y * map.W + p.x]; };
+  std::vector<int> distance(work.size(), -1);
+  std::vector<int> parent(work.size(), -1);
 
-  std::queue<Point> que;
-  if (work(start) & FOREGROUND) {
-    que.push(start);
-    work(start) |= VISITED;
-    parent(start) = start;
-    distance(start) = 0;
+  std::queue<int> que;
+  const int s = index(start);
+  if (work[s] & FOREGROUND) {
+    que.push(s);
+    work[s] |= VISITED;
+    parent[s] = s;
+    distance[s] = 0;
   }
   while (!que.empty()) {
-    Point p = que.front(); que.pop();
-    if (work(p) & TARGET) {
+    const int i = que.front(); que.pop();
+    if (work[i] & TARGET) {
       // backtrack.
-      std::vector<Point> path { p };
-      while (parent(path.back()) != path.back()) {
-        auto new_point = parent(path.back());
-        assert (work.isInside(new_point));
-        path.push_back(new_point);
+      std::vector<Point> path { point(i) };
+      for (int j = i; parent[j] != j;) {
+        j = parent[j];
+        assert (map.isInside(point(j)));
+        path.push_back(point(j));
       }
       std::reverse(path.begin(), path.end());
       return path;
     }
-    const int next_distance = distance(p) + 1;
+    const int next_distance = distance[i] + 1;
     if (max_distance < 0 /* no limit */ || next_distance <= max_distance) {
-      for (auto offset : all_directions) {
-        Point n = p + Point(offset);
-        if (work.isInside(n) && (work(n) & VISITED) == 0 && (work(n) & FOREGROUND)) {
+      for (int offset : neighbor_offsets) {
+        const int n = i + offset;
+        if ((work[n] & (VISITED | FOREGROUND)) == FOREGROUND) {
           que.push(n);
-          work(n) |= VISITED;
-          parent(n) = p;
-          distance(n) = next_distance;
+          work[n] |= VISITED;
+          parent[n] = i;
+          distance[n] = next_distance;
         }
       }
     }
@@ -241,9 +253,107 @@ std::vector<Booster> ParseBoosters(char*& p) {
   return boosters;
 }
 
+// parseDescString() の assert に引っかからないかを事前に調べる。
+class DescChecker {
+public:
+  explicit DescChecker(const std::string& s_) : s(s_) {}
+
+  bool check(std::string* error) {
+    std::vector<Point> map_pos;
+    if (!polygon(map_pos)) return fail("broken map", error);
+    if (!consume('#')) return fail("'#' is expected", error);
+    Point wrappy;
+    if (!point(wrappy)) return fail("broken wrappy", error);
+    if (!consume('#')) return fail("'#' is expected", error);
+    std::vector<std::vector<Point>> obstacles;
+    if (peek() != '#') {
+      do {
+        obstacles.emplace_back();
+        if (!polygon(obstacles.back())) return fail("broken obstacle", error);
+      } while (consume(';'));
+    }
+    if (!consume('#')) return fail("'#' is expected", error);
+    std::vector<Point> boosters;
+    if (i < s.size()) {
+      do {
+        if (std::strchr("BFLCXR", peek()) == nullptr || peek() == '\0') return fail("unknown booster", error);
+        ++i;
+        boosters.emplace_back();
+        if (!point(boosters.back())) return fail("broken booster", error);
+      } while (consume(';'));
+    }
+    while (!boosters.empty() && i < s.size() && std::isspace(s[i])) ++i;
+    if (i != s.size()) return fail("garbage at the end", error);
+
+    // Map2D(upper.x, upper.y) が確保できて、fillPolygon() が範囲外を塗らないこと。
+    BoundingBox bbox = calcBoundingBox(map_pos);
+    if (bbox.lower.x < 0 || bbox.lower.y < 0 || !bbox.isValid()) return reject("bad bounding box", error);
+    const Point upper = bbox.upper;
+    auto inside_box = [&](Point p) { return 0 <= p.x && p.x <= upper.x && 0 <= p.y && p.y <= upper.y; };
+    auto inside_map = [&](Point p) { return 0 <= p.x && p.x < upper.x && 0 <= p.y && p.y < upper.y; };
+    for (const auto& obstacle : obstacles) {
+      if (!std::all_of(obstacle.begin(), obstacle.end(), inside_box)) return reject("obstacle out of the map", error);
+    }
+    if (!inside_map(wrappy)) return reject("wrappy out of the map", error);
+    if (!std::all_of(boosters.begin(), boosters.end(), inside_map)) return reject("booster out of the map", error);
+    return true;
+  }
+
+private:
+  static constexpr int kMaxCoord = 4096;
+
+  char peek() const { return i < s.size() ? s[i] : '\0'; }
+  bool consume(char c) {
+    if (peek() != c) return false;
+    ++i;
+    return true;
+  }
+  bool number(int& v) {
+    bool negative = consume('-');
+    if (!std::isdigit(peek())) return false;
+    v = 0;
+    while (std::isdigit(peek())) {
+      v = v * 10 + (s[i++] - '0');
+      if (v > kMaxCoord) return false;
+    }
+    if (negative) v = -v;
+    return true;
+  }
+  bool point(Point& p) {
+    return consume('(') && number(p.x) && consume(',') && number(p.y) && consume(')');
+  }
+  // fillPolygon() は辺が軸に平行であることを仮定している。
+  bool polygon(std::vector<Point>& ps) {
+    do {
+      ps.emplace_back();
+      if (!point(ps.back())) return false;
+    } while (consume(','));
+    if (ps.size() < 4) return false;
+    for (size_t k = 0; k < ps.size(); ++k) {
+      const Point a = ps[k], b = ps[(k + 1) % ps.size()];
+      if ((a.x == b.x) == (a.y == b.y)) return false;
+    }
+    return true;
+  }
+  bool fail(const char* message, std::string* error) {
+    return reject((std::string(message) + " at " + std::to_string(i)).c_str(), error);
+  }
+  bool reject(const char* message, std::string* error) {
+    if (error) *error = message;
+    return false;
+  }
+
+  const std::string& s;
+  size_t i = 0;
+};
+
 }  // namespace
 
 
+bool isValidDescString(const std::string& desc_string, std::string* error) {
+  return DescChecker(desc_string).check(error);
+}
+
 ParsedMap parseDescString(std::string desc_string) {
   ParsedMap map;
   char* p = const_cast<char*>(desc_string.data());
@@ -10,7 +10,10 @@
 #include "base.h"
 #include "booster.h"
 
+// bounds checks of Map2D cells. off in release builds. (NDEBUG)
+#ifndef NDEBUG
 #define MAP2D_CHECK_INSIDE
+#endif
 #ifdef MAP2D_CHECK_INSIDE
 # define MAP2D_ASSERT(eq) assert(eq)
 #else
@@ -130,6 +133,8 @@ struct ParsedMap {
 };
 // parse *.desc string to construct Map2D and obtain other info.
 ParsedMap parseDescString(std::string desc_string);
+// check the syntax and ranges of a *.desc string without asserting, for untrusted inputs.
+bool isValidDescString(const std::string& desc_string, std::string* error = nullptr);
 
 // parse *.map string to construct Map2D and obtain other info.
 // map_strings_top_to_bottom[H - 1 - y] corresponds to the y-line.
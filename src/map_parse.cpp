@@ -1,5 +1,8 @@
 #include "map_parse.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <queue>
@@ -25,10 +28,19 @@ bool operator<(const Trajectory &t1, const Trajectory &t2) {
 using TrajectoryMap = std::vector<std::vector<Trajectory>>;
 using UpdateCallback = std::function<bool(Trajectory&, Trajectory&)>;
 
+namespace {
+
+bool isReserved(const ReservationTable* reservation, const Point& p) {
+  return reservation && reservation->isReserved(p);
+}
+
+} // namespace
+
 TrajectoryMap generateTrajectoryMap(const Game &game,
                                     const Point &from,
                                     const int max_dist,
-                                    const UpdateCallback& update_callback, const bool dstart=false, const bool astart=false) {
+                                    const UpdateCallback& update_callback, const bool dstart=false, const bool astart=false,
+                                    const ReservationTable* reservation=nullptr) {
   const int kXMax = game.map2d.W;
   const int kYMax = game.map2d.H;
 
@@ -62,16 +74,14 @@ TrajectoryMap generateTrajectoryMap(const Game &game,
       case Direction::A: --x_try; break;
       }
 
-      if (x_try > kXMax - 1 || x_try < 0 || y_try > kYMax - 1 || y_try < 0) {
-        return;
-      }
-      if (game.map2d(x_try, y_try) & CellType::kObstacleBit) {
-        // todo write drill
+      // out of the map or obstacle. todo write drill
+      if (game.obstacle_map(x_try, y_try) != PaddedObstacleMap::kFree) {
         return;
       }
 
       // If the destination cell is already wrapped, add an extra cost.
-      int cost = (game.map2d(x_try, y_try) & CellType::kWrappedBit) ? 2 : 1;
+      // (reserved cells cost the same, as when they were hidden under wrapped cells)
+      int cost = ((game.map2d(x_try, y_try) & CellType::kWrappedBit) || isReserved(reservation, {x_try, y_try})) ? 2 : 1;
 
       Trajectory traj_try = traj;
       traj_try.distance += cost;
@@ -141,8 +151,23 @@ std::vector<Trajectory> findTrajectory(const Game &game, const Point &from, cons
   return trajs;  
 }
 
-std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from, const int max_dist, const bool dstart, const bool astart) {
+namespace {
+
+std::vector<Trajectory> findNearestUnwrappedAStarImpl(const Game &game, const Point& from, const int max_dist,
+                                                      const ReservationTable* reservation, const bool dstart, const bool astart);
+
+std::vector<Trajectory> findNearestUnwrappedImpl(const Game &game, const Point& from, const int max_dist,
+                                                 const ReservationTable* reservation, const bool dstart, const bool astart) {
   static constexpr int kMask = CellType::kObstacleBit | CellType::kWrappedBit;
+  // 近くに未塗装セルがなければ flood fill せずに A* で探す
+  static constexpr int kAStarMinDistance = 8;
+  if (game.unwrapped_pyramid.count() == 0) {
+    return std::vector<Trajectory>(0);
+  }
+  if (game.unwrapped_pyramid.localDistance(from, kAStarMinDistance) >= kAStarMinDistance) {
+    return findNearestUnwrappedAStarImpl(game, from, max_dist, reservation, dstart, astart);
+  }
+
   int nearest = DISTANCE_INF;
   Point nearest_point = {-1, -1};
 
@@ -152,6 +177,7 @@ std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from
         if (traj_new < traj_orig) {
           traj_orig = traj_new;
           if ((game.map2d(traj_new.pos.x, traj_new.pos.y) & kMask) == 0 &&
+              !isReserved(reservation, traj_new.pos) &&
               traj_new.distance < nearest) {
             nearest_point = traj_new.pos;
             nearest = traj_new.distance;
@@ -184,7 +210,109 @@ std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from
 
 }
 
-  std::vector<Trajectory> findNearestByBit(const Game &game, const Point& from, const int max_dist, const int kMask, const bool dstart, const bool astart) {
+std::vector<Trajectory> findNearestUnwrappedAStarImpl(const Game &game, const Point& from, const int max_dist,
+                                                      const ReservationTable* reservation, const bool dstart, const bool astart) {
+  static constexpr int kMask = CellType::kObstacleBit | CellType::kWrappedBit;
+  const Map2D& map = game.map2d;
+  // the nearest non-empty tile of a coarse level. (consistent, and O(kMaxTiles) per cell)
+  static constexpr int kMaxTiles = 16;
+  const UnwrappedPyramid::TileBound bound = game.unwrapped_pyramid.tileBound(kMaxTiles);
+  const int N = map.W * map.H;
+
+  // scratch buffers reused among calls. a cell is valid if stamp[i] == generation.
+  struct Scratch {
+    std::vector<uint32_t> stamp;
+    std::vector<int> steps;
+    std::vector<int> heuristic;
+    std::vector<Direction> last_move;
+    std::vector<std::vector<std::pair<int, int>>> buckets; // f - f0 -> [(cell, steps)]
+    uint32_t generation = 0;
+  };
+  thread_local Scratch s;
+  if (s.stamp.size() < N) {
+    s.stamp.assign(N, 0);
+    s.steps.resize(N);
+    s.heuristic.resize(N);
+    s.last_move.resize(N);
+    s.generation = 0;
+  }
+  if (++s.generation == 0) {
+    std::fill(s.stamp.begin(), s.stamp.end(), 0);
+    s.generation = 1;
+  }
+  for (auto& bucket : s.buckets) bucket.clear();
+
+  auto h = [&](int i) {
+    if (s.stamp[i] != s.generation) {
+      s.stamp[i] = s.generation;
+      s.steps[i] = DISTANCE_INF;
+      s.heuristic[i] = bound({i % map.W, i / map.W});
+    }
+    return s.heuristic[i];
+  };
+
+  std::vector<Direction> order = {Direction::W, Direction::A, Direction::S, Direction::D};
+  if (dstart) order = {Direction::D, Direction::W, Direction::A, Direction::S};
+  if (astart) order = {Direction::A, Direction::S, Direction::D, Direction::W};
+
+  const int start = from.y * map.W + from.x;
+  const int f0 = h(start);
+  if (f0 == DISTANCE_INF) {
+    return std::vector<Trajectory>(0);
+  }
+  s.steps[start] = 0;
+  if (s.buckets.empty()) s.buckets.emplace_back();
+  s.buckets[0].emplace_back(start, 0);
+
+  int goal = -1;
+  for (int f = 0; f < s.buckets.size() && goal < 0; ++f) {
+    while (!s.buckets[f].empty()) {
+      const int i = s.buckets[f].back().first;
+      const int k = s.buckets[f].back().second;
+      s.buckets[f].pop_back();
+      if (k != s.steps[i]) continue; // outdated
+      if (k > 0 && (map.data[i] & kMask) == 0 && !isReserved(reservation, {i % map.W, i / map.W})) {
+        goal = i;
+        break;
+      }
+      // wrapped cells cost 2 in findNearestUnwrapped().
+      if (2 * k > max_dist) continue;
+
+      const Point p(i % map.W, i / map.W);
+      for (auto dir : order) {
+        const Point n = p + Point(dir);
+        if (!game.obstacle_map.isFree(n)) continue;
+        const int j = n.y * map.W + n.x;
+        const int hj = h(j);
+        if (k + 1 >= s.steps[j]) continue;
+        s.steps[j] = k + 1;
+        s.last_move[j] = dir;
+        const int fj = k + 1 + hj - f0;
+        while (s.buckets.size() <= fj) s.buckets.emplace_back();
+        s.buckets[fj].emplace_back(j, k + 1);
+      }
+    }
+  }
+  if (goal < 0) {
+    return std::vector<Trajectory>(0);
+  }
+
+  std::vector<Trajectory> trajs;
+  for (int i = goal; i != start;) {
+    const Point p(i % map.W, i / map.W);
+    trajs.push_back(Trajectory{s.last_move[i], p, 0, false});
+    const Point prev = p - Point(s.last_move[i]);
+    i = prev.y * map.W + prev.x;
+  }
+  std::reverse(trajs.begin(), trajs.end());
+  for (int i = 0; i < trajs.size(); ++i) {
+    trajs[i].distance = 2 * (i + 1) - (i + 1 == trajs.size() ? 1 : 0);
+  }
+  return trajs;
+}
+
+std::vector<Trajectory> findNearestByBitImpl(const Game &game, const Point& from, const int max_dist, const int kMask,
+                                             const ReservationTable* reservation, const bool dstart, const bool astart) {
 
   int nearest = DISTANCE_INF;
   Point nearest_point = {-1, -1};
@@ -195,6 +323,7 @@ std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from
         if (traj_new < traj_orig) {
           traj_orig = traj_new;
           if ((game.map2d(traj_new.pos.x, traj_new.pos.y) & kMask) != 0 &&
+              !isReserved(reservation, traj_new.pos) &&
               traj_new.distance < nearest) {
             nearest_point = traj_new.pos;
             nearest = traj_new.distance;
@@ -203,7 +332,7 @@ std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from
           }
         }
         return false;  // Won't enqueue |traj_new|
-      }, dstart, astart);
+      }, dstart, astart, reservation);
 
   if (nearest == DISTANCE_INF){
     return std::vector<Trajectory>(0);
@@ -224,7 +353,150 @@ std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from
   }
   std::reverse(trajs.begin(), trajs.end());
   return trajs;
+}
+
+} // namespace
+
+std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from, const int max_dist, const bool dstart, const bool astart) {
+  return findNearestUnwrappedImpl(game, from, max_dist, nullptr, dstart, astart);
+}
+
+std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point& from, const int max_dist,
+                                             const ReservationTable& reservation, const bool dstart, const bool astart) {
+  return findNearestUnwrappedImpl(game, from, max_dist, &reservation, dstart, astart);
+}
+
+std::vector<Trajectory> findNearestUnwrappedAStar(const Game &game, const Point& from, const int max_dist, const bool dstart, const bool astart) {
+  return findNearestUnwrappedAStarImpl(game, from, max_dist, nullptr, dstart, astart);
+}
+
+std::vector<Trajectory> findNearestByBit(const Game &game, const Point& from, const int max_dist, const int kMask, const bool dstart, const bool astart) {
+  return findNearestByBitImpl(game, from, max_dist, kMask, nullptr, dstart, astart);
+}
+
+std::vector<Trajectory> findNearestByBit(const Game &game, const Point& from, const int max_dist, const int kMask,
+                                         const ReservationTable& reservation, const bool dstart, const bool astart) {
+  return findNearestByBitImpl(game, from, max_dist, kMask, &reservation, dstart, astart);
+}
+
+std::vector<std::vector<Trajectory>> allocateNearestByBit(const Game &game, const std::vector<SearchSource>& sources,
+                                                          const int max_dist, const int kMask, ReservationTable& reservation) {
+  const Map2D& map = game.map2d;
+  const int N = map.W * map.H;
+
+  // one Dijkstra per source. they advance a distance level together, so that
+  // the nearest (source, target) pairs are fixed first.
+  struct Search {
+    std::vector<int> distance;
+    std::vector<Direction> last_move;
+    std::vector<std::vector<int>> buckets; // distance -> cells (LIFO, as generateTrajectoryMap)
+    int pending = 0;
+    std::vector<int> candidates; // targets in the discovered order.
+    bool done = false;
+  };
+  std::vector<Search> searches(sources.size());
+  std::vector<std::vector<Trajectory>> result(sources.size());
+  int remaining = sources.size();
+  for (int k = 0; k < sources.size(); ++k) {
+    Search& s = searches[k];
+    const Point& from = sources[k].pos;
+    s.distance.assign(N, DISTANCE_INF);
+    s.last_move.assign(N, Direction::W);
+    s.distance[from.y * map.W + from.x] = 0;
+    s.buckets.emplace_back(1, from.y * map.W + from.x);
+    s.pending = 1;
+  }
+  auto isTarget = [&](int i) {
+    return (map.data[i] & kMask) != 0 && !reservation.isReserved({i % map.W, i / map.W});
+  };
+
+  for (int d = 0; remaining > 0; ++d) {
+    for (int k = 0; k < sources.size(); ++k) {
+      Search& s = searches[k];
+      if (s.done) continue;
+
+      std::vector<Direction> order = {Direction::W, Direction::A, Direction::S, Direction::D};
+      if (sources[k].dstart) order = {Direction::D, Direction::W, Direction::A, Direction::S};
+      if (sources[k].astart) order = {Direction::A, Direction::S, Direction::D, Direction::W};
+
+      while (d < s.buckets.size() && !s.buckets[d].empty()) {
+        const int i = s.buckets[d].back();
+        s.buckets[d].pop_back();
+        --s.pending;
+        if (s.distance[i] != d || d > max_dist) continue;
+        const Point p(i % map.W, i / map.W);
+        for (auto dir : order) {
+          const Point n = p + Point(dir);
+          if (!game.obstacle_map.isFree(n)) continue;
+          const int j = n.y * map.W + n.x;
+          // If the destination cell is already wrapped, add an extra cost.
+          const int nd = d + ((map.data[j] & CellType::kWrappedBit) ? 2 : 1);
+          if (nd >= s.distance[j]) continue;
+          s.distance[j] = nd;
+          s.last_move[j] = dir;
+          if (isTarget(j)) {
+            s.candidates.push_back(j);
+          }
+          // targets are also expanded, in case they are reserved by other sources later.
+          while (s.buckets.size() <= nd) s.buckets.emplace_back();
+          s.buckets[nd].push_back(j);
+          ++s.pending;
+        }
+      }
 
+      // the nearest unreserved candidate. (the first discovered one on ties)
+      int best = -1;
+      for (int c : s.candidates) {
+        if (isTarget(c) && (best < 0 || s.distance[c] < s.distance[best])) {
+          best = c;
+        }
+      }
+      // cells popped later are at distance > d, so their neighbors are at distance >= d + 2.
+      const bool fixed = best >= 0 && (s.distance[best] <= d + 2 || s.pending == 0);
+      if (!fixed && s.pending > 0) continue;
+
+      s.done = true;
+      --remaining;
+      if (best < 0) continue;
+      reservation.reserve({best % map.W, best / map.W}, sources[k].owner);
+      auto& trajs = result[k];
+      for (int i = best; i != sources[k].pos.y * map.W + sources[k].pos.x;) {
+        const Point p(i % map.W, i / map.W);
+        trajs.push_back(Trajectory{s.last_move[i], p, s.distance[i], false});
+        const Point prev = p - Point(s.last_move[i]);
+        i = prev.y * map.W + prev.x;
+      }
+      std::reverse(trajs.begin(), trajs.end());
+      // release memory early.
+      s.distance = {};
+      s.last_move = {};
+      s.buckets = {};
+    }
   }
-  
+  return result;
+}
+
+ReservationTable::ReservationTable(int W_, int H_) : W(W_), owners(W_ * std::max(H_, 0), -1) {}
+
+bool ReservationTable::reserve(const Point& p, int owner) {
+  assert (owner >= 0);
+  int& o = owners[p.y * W + p.x];
+  if (o >= 0) return o == owner;
+  o = owner;
+  cells.push_back(p);
+  return true;
+}
+
+void ReservationTable::release(const Point& p) {
+  int& o = owners[p.y * W + p.x];
+  if (o < 0) return;
+  o = -1;
+  cells.erase(std::find(cells.begin(), cells.end(), p));
+}
+
+void ReservationTable::clear() {
+  for (auto& p : cells) owners[p.y * W + p.x] = -1;
+  cells.clear();
+}
+
 } // namespace map_parse
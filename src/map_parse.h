@@ -7,13 +7,59 @@
 
 namespace map_parse {
 
+  // cells reserved as targets by wrappers, shared among them.
+  // searches taking it do not treat reserved cells as targets (they are still passable).
+  class ReservationTable {
+  public:
+    ReservationTable(int W, int H);
+    explicit ReservationTable(const Map2D& map) : ReservationTable(map.W, map.H) {}
+    // returns false if the cell is reserved by another owner.
+    bool reserve(const Point& p, int owner);
+    void release(const Point& p);
+    void clear();
+    bool isReserved(const Point& p) const { return owners[p.y * W + p.x] >= 0; }
+    int owner(const Point& p) const { return owners[p.y * W + p.x]; } // -1 if not reserved.
+    const std::vector<Point>& reservedCells() const { return cells; }
+  private:
+    int W;
+    std::vector<int> owners;
+    std::vector<Point> cells;
+  };
+
   std::vector<Trajectory> findTrajectory(const Game &game, const Point &from, const Point &to,
 					 const int max_dist, const bool dstart=false, const bool astart=false);
   std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point &from,
 					       const int max_dist, const bool dstart=false, const bool astart=false);
+  // A* version of findNearestUnwrapped() guided by the non-empty tiles of a coarse level of game.unwrapped_pyramid.
+  // the path length is the same, but the target may differ on ties.
+  // findNearestUnwrapped() switches to it when the nearest unwrapped cell is far away.
+  std::vector<Trajectory> findNearestUnwrappedAStar(const Game &game, const Point &from,
+					       const int max_dist, const bool dstart=false, const bool astart=false);
 
   std::vector<Trajectory> findNearestByBit(const Game &game, const Point &from,
 					   const int max_dist, const int kMask, const bool dstart=false, const bool astart=false);
+
+  // variants skipping cells in |reservation|. reserved cells are still passable.
+  // (findNearestByBit charges them as wrapped cells)
+  std::vector<Trajectory> findNearestUnwrapped(const Game &game, const Point &from,
+					       const int max_dist, const ReservationTable& reservation,
+					       const bool dstart=false, const bool astart=false);
+  std::vector<Trajectory> findNearestByBit(const Game &game, const Point &from,
+					   const int max_dist, const int kMask, const ReservationTable& reservation,
+					   const bool dstart=false, const bool astart=false);
+
+  struct SearchSource {
+    Point pos;
+    int owner; // id in ReservationTable. e.g.) wrapper index
+    bool dstart = false;
+    bool astart = false;
+  };
+  // assigns distinct targets with kMask to sources. it runs one Dijkstra per source (N-sized buffers each),
+  // advanced a distance level at a time, so that the nearest (source, target) pairs are fixed first.
+  // assigned targets are reserved in |reservation|.
+  // result[k] is the trajectory for sources[k]. (empty if no target is left)
+  std::vector<std::vector<Trajectory>> allocateNearestByBit(const Game &game, const std::vector<SearchSource>& sources,
+							    const int max_dist, const int kMask, ReservationTable& reservation);
   
 
 } // namepsace map_parse
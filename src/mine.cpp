@@ -0,0 +1,99 @@
+#include "mine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "solution.h"
+
+namespace {
+
+// time steps of the command if it wraps all cells. -1 otherwise.
+int verifiedTime(const Game& initial, const std::string& command) {
+  Game game(initial);
+  if (!replaySolution(&game, parseSolutionString(command)) || !game.isEnd()) return -1;
+  return game.time;
+}
+
+double secondsSinceEpoch() {
+  return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+MineResult mineBlock(const Puzzle& puzzle, const Game& task, const MineParam& param) {
+  MineResult result;
+  std::mutex mutex; // guards result and the log.
+  auto log = [&](const std::string& name, const std::string& message) {
+    if (!param.verbose) return;
+    std::cerr << "mine: " << name << " => " << message << std::endl;
+  };
+
+  // an unknown puzzle solver leaves the puzzle unsolved. (puzzle_valid = false)
+  std::thread puzzle_thread;
+  if (SolverRegistry<PuzzleSolverFunction>::getRegistry().count(param.puzzle_solver) == 0) {
+    std::cerr << "mine: unknown puzzle solver " << param.puzzle_solver << std::endl;
+  } else {
+    puzzle_thread = std::thread([&]() {
+      PuzzleSolverFunction solver = SolverRegistry<PuzzleSolverFunction>::getSolver(param.puzzle_solver);
+      PuzzleSolution solution = solver(PuzzleSolverParam(), puzzle);
+      const bool valid = puzzle.validateSolution(solution);
+      std::lock_guard<std::mutex> lock(mutex);
+      log(param.puzzle_solver, valid ? "valid" : "invalid");
+      result.puzzle_valid = valid;
+      result.puzzle_solution = solution;
+    });
+  }
+
+  std::vector<std::string> engines;
+  for (auto& e : param.engines) {
+    if (SolverRegistry<SolverFunction>::getRegistry().count(e) == 0) {
+      std::cerr << "mine: unknown engine " << e << std::endl;
+      continue;
+    }
+    engines.push_back(e);
+  }
+
+  // runs which become longer than the best are terminated.
+  // the deadline applies only after some solution is found, so that the block always gets an answer.
+  std::atomic<int> best_time(INT_MAX);
+  auto keep_going = [&](Game* g) {
+    const int best = best_time.load();
+    if (g->time >= best) return false;
+    return best == INT_MAX || !param.solver_param.hasDeadline() || secondsSinceEpoch() < param.solver_param.deadline;
+  };
+  auto run = [&](const std::string& engine) {
+    Game game(task);
+    SolverFunction solver = SolverRegistry<SolverFunction>::getSolver(engine);
+    solver(param.solver_param, &game, keep_going);
+    const int time = game.isEnd() ? verifiedTime(task, game.getCommand()) : -1;
+    std::lock_guard<std::mutex> lock(mutex);
+    log(engine, time < 0 ? std::string("invalid") : std::to_string(time));
+    if (time < 0 || (result.task_valid && result.task_time <= time)) return;
+    result.task_valid = true;
+    result.task_time = time;
+    result.task_command = game.getCommand();
+    result.task_engine = engine;
+    for (int b = best_time.load(); time < b && !best_time.compare_exchange_weak(b, time);) {}
+  };
+
+  // engines keep per-thread counters, so every run gets a fresh thread.
+  int num_threads = param.num_threads > 0 ? param.num_threads : std::thread::hardware_concurrency();
+  num_threads = std::max(num_threads, 1);
+  std::atomic<int> next(0);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < num_threads && i < engines.size(); ++i) {
+    workers.emplace_back([&]() {
+      for (int k; (k = next++) < engines.size();) {
+        std::thread(run, engines[k]).join();
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+  if (puzzle_thread.joinable()) puzzle_thread.join();
+  return result;
+}
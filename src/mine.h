@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "game.h"
+#include "puzzle.h"
+#include "solver_registry.h"
+
+// solve a block of the mining game in one process.
+// the puzzle solver and all task engines run concurrently, and both results are validated.
+struct MineParam {
+  std::string puzzle_solver = "outBFS";
+  std::vector<std::string> engines;
+  int num_threads = 0;      // # of concurrent engines. 0: std::thread::hardware_concurrency()
+  SolverParam solver_param; // engines are stopped at its deadline once any valid solution is found.
+  bool verbose = false;
+};
+
+struct MineResult {
+  bool puzzle_valid = false;
+  PuzzleSolution puzzle_solution;
+
+  bool task_valid = false;
+  int task_time = 0;
+  std::string task_command;
+  std::string task_engine;
+};
+
+// the puzzle solver can not be interrupted, so it may outlive the deadline.
+MineResult mineBlock(const Puzzle& puzzle, const Game& task, const MineParam& param);
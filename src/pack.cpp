@@ -0,0 +1,136 @@
+#include "pack.h"
+
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kPackMagic[8] = {'W', 'R', 'A', 'P', 'P', 'A', 'C', 'K'};
+constexpr uint32_t kPackVersion = 1;
+constexpr int kMaxNameLength = 31;
+
+struct PackHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_entries;
+};
+
+} // namespace
+
+struct DatasetPackEntry {
+  char name[kMaxNameLength + 1];
+  int32_t W;
+  int32_t H;
+  int32_t num_unwrapped;
+  int32_t wrappy_x;
+  int32_t wrappy_y;
+  uint32_t reserved;
+  uint64_t offset; // of the cells from the head of the file.
+};
+
+bool writeDatasetPack(const std::vector<std::pair<std::string, std::string>>& named_descs, const std::string& pack_path) {
+  std::vector<DatasetPackEntry> entries;
+  std::vector<Map2D> maps;
+  uint64_t offset = sizeof(PackHeader) + sizeof(DatasetPackEntry) * named_descs.size();
+  for (auto& nd : named_descs) {
+    if (nd.first.size() > kMaxNameLength) return false;
+    ParsedMap parsed = parseDescString(nd.second);
+    DatasetPackEntry e = {};
+    std::strncpy(e.name, nd.first.c_str(), kMaxNameLength);
+    e.W = parsed.map2d.W;
+    e.H = parsed.map2d.H;
+    e.num_unwrapped = parsed.map2d.num_unwrapped;
+    e.wrappy_x = parsed.wrappy.x;
+    e.wrappy_y = parsed.wrappy.y;
+    e.offset = offset;
+    offset += sizeof(int32_t) * parsed.map2d.data.size();
+    entries.push_back(e);
+    maps.push_back(std::move(parsed.map2d));
+  }
+
+  const std::string tmp_path = pack_path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::binary);
+    PackHeader header = {};
+    std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version = kPackVersion;
+    header.num_entries = entries.size();
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(entries.data()), sizeof(DatasetPackEntry) * entries.size());
+    static_assert(sizeof(Map2D::T) == sizeof(int32_t), "cells are written as they are");
+    for (auto& m : maps) {
+      ofs.write(reinterpret_cast<const char*>(m.data.data()), sizeof(int32_t) * m.data.size());
+    }
+    if (!ofs.flush()) return false;
+  }
+  return std::rename(tmp_path.c_str(), pack_path.c_str()) == 0;
+}
+
+std::unique_ptr<DatasetPack> DatasetPack::open(const std::string& pack_path) {
+  const int fd = ::open(pack_path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < sizeof(PackHeader)) {
+    close(fd);
+    return nullptr;
+  }
+  void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return nullptr;
+
+  std::unique_ptr<DatasetPack> pack(new DatasetPack());
+  pack->base = base;
+  pack->length = st.st_size;
+
+  // validate the whole index here, so that lookups need no checks.
+  const PackHeader& header = *static_cast<const PackHeader*>(base);
+  if (std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) != 0 || header.version != kPackVersion) return nullptr;
+  if (sizeof(PackHeader) + uint64_t(sizeof(DatasetPackEntry)) * header.num_entries > pack->length) return nullptr;
+  pack->num_entries = header.num_entries;
+  for (int i = 0; i < pack->num_entries; ++i) {
+    const DatasetPackEntry& e = pack->entry(i);
+    if (e.name[kMaxNameLength] != '\0' || e.W < 0 || e.H < 0) return nullptr;
+    if (e.offset % sizeof(int32_t) != 0 || e.offset + sizeof(int32_t) * uint64_t(e.W) * e.H > pack->length) return nullptr;
+    if (!(0 <= e.wrappy_x && e.wrappy_x < e.W && 0 <= e.wrappy_y && e.wrappy_y < e.H)) return nullptr;
+  }
+  return pack;
+}
+
+DatasetPack::~DatasetPack() {
+  munmap(base, length);
+}
+
+const DatasetPackEntry& DatasetPack::entry(int i) const {
+  assert (0 <= i && i < num_entries);
+  return reinterpret_cast<const DatasetPackEntry*>(static_cast<const char*>(base) + sizeof(PackHeader))[i];
+}
+
+std::string DatasetPack::name(int i) const {
+  return entry(i).name;
+}
+
+int DatasetPack::find(const std::string& name) const {
+  for (int i = 0; i < num_entries; ++i) {
+    if (name == entry(i).name) return i;
+  }
+  return -1;
+}
+
+ParsedMap DatasetPack::parsedMap(int i) const {
+  const DatasetPackEntry& e = entry(i);
+  const int32_t* cells = reinterpret_cast<const int32_t*>(static_cast<const char*>(base) + e.offset);
+  ParsedMap parsed;
+  parsed.map2d.W = e.W;
+  parsed.map2d.H = e.H;
+  parsed.map2d.num_unwrapped = e.num_unwrapped;
+  parsed.map2d.data.assign(cells, cells + e.W * e.H);
+  parsed.wrappy = Point(e.wrappy_x, e.wrappy_y);
+  return parsed;
+}
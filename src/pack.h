@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "game.h"
+
+// binary pack of parsed *.desc files. map layers are stored as they are after rasterization,
+// so a game is made by a bulk copy from the memory-mapped file instead of parsing and filling polygons.
+// layout (native byte order):
+//   header  : magic "WRAPPACK", version, # of entries
+//   entries : name, W, H, num_unwrapped, start position, offset of cells
+//   cells   : W * H int32 per entry (boosters and spawn points are in the cells)
+struct DatasetPackEntry;
+
+// (name, *.desc string). names are file stems, e.g.) prob-001. at most 31 characters.
+bool writeDatasetPack(const std::vector<std::pair<std::string, std::string>>& named_descs, const std::string& pack_path);
+
+class DatasetPack {
+public:
+  // nullptr if the file can not be mapped or is broken.
+  static std::unique_ptr<DatasetPack> open(const std::string& pack_path);
+  ~DatasetPack();
+  DatasetPack(const DatasetPack&) = delete;
+  DatasetPack& operator=(const DatasetPack&) = delete;
+
+  int size() const { return num_entries; }
+  std::string name(int i) const;
+  int find(const std::string& name) const; // -1 if not found.
+  ParsedMap parsedMap(int i) const;
+  std::unique_ptr<Game> makeGame(int i) const { return std::unique_ptr<Game>(new Game(parsedMap(i))); }
+
+private:
+  DatasetPack() = default;
+  const DatasetPackEntry& entry(int i) const;
+
+  void* base = nullptr;
+  size_t length = 0;
+  int num_entries = 0;
+};
@@ -0,0 +1,14 @@
+#include "padded_obstacle_map.h"
+
+void PaddedObstacleMap::reset(const Map2D& map) {
+  W = map.W;
+  H = map.H;
+  stride = W + 2 * kPadding;
+  cells.assign(stride * (map.H + 2 * kPadding), kOutside);
+  for (int y = 0; y < map.H; ++y) {
+    uint8_t* row = &cells[index({0, y})];
+    for (int x = 0; x < map.W; ++x) {
+      row[x] = (map(x, y) & CellType::kObstacleBit) ? kObstacle : kFree;
+    }
+  }
+}
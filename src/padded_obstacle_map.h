@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "base.h"
+#include "map2d.h"
+
+// obstacle layer of the map surrounded by kPadding sentinel cells, addressed by linear indices.
+// cells out of the map read as kOutside, so neighbors of a cell on the map and manipulator arms up to
+// kPadding cells long are tested without bounds checks.
+// Game keeps it in sync in paint() and Wrapper::undoAction().
+class PaddedObstacleMap {
+public:
+  static constexpr int kPadding = 4;
+  enum : uint8_t { kFree = 0, kObstacle = 1, kOutside = 2 };
+
+  PaddedObstacleMap() = default;
+  explicit PaddedObstacleMap(const Map2D& map) { reset(map); }
+
+  void reset(const Map2D& map);
+  void set(Point p, bool obstacle) { cells[index(p)] = obstacle ? kObstacle : kFree; }
+
+  bool isInside(Point p) const { return 0 <= p.x && p.x < W && 0 <= p.y && p.y < H; }
+  // p must be within kPadding cells from the map.
+  int index(Point p) const { return (p.y + kPadding) * stride + (p.x + kPadding); }
+  int offset(Point d) const { return d.y * stride + d.x; }
+  uint8_t at(int i) const { return cells[i]; }
+  uint8_t operator()(Point p) const { return cells[index(p)]; }
+  uint8_t operator()(int x, int y) const { return cells[index({x, y})]; }
+  bool isFree(Point p) const { return operator()(p) == kFree; }
+
+private:
+  int W = 0;
+  int H = 0;
+  int stride = 0;
+  std::vector<uint8_t> cells;
+};
@@ -14,94 +14,183 @@ constexpr int IN = 1;
 constexpr int OUT = 2;
 
 bool Puzzle::validateSolution(const PuzzleSolution& solution) const {
-  std::cerr << "validateSolution() is incomplete!!" << std::endl;
-  bool valid = true;
-  int xmax = 0, ymax = 0;
-  for (auto p : solution.wall) {
+  std::string reason;
+  if (!PuzzleValidator(*this).validate(solution, &reason)) {
+    std::cerr << reason << std::endl;
+    return false;
+  }
+  return true;
+}
+
+PuzzleValidator::PuzzleValidator(const Puzzle& puzzle_)
+  : puzzle(puzzle_)
+  , min_size(puzzle_.tSize - puzzle_.tSize / 10)
+  , min_area((puzzle_.tSize * puzzle_.tSize * 2 + 10 - 1) / 10)
+  , room(puzzle_.tSize + 2, puzzle_.tSize + 2)
+  , used(puzzle_.tSize + 2, puzzle_.tSize + 2) {
+}
+
+bool PuzzleValidator::isRoom(Point p) const {
+  return 0 <= p.x && p.x < puzzle.tSize && 0 <= p.y && p.y < puzzle.tSize && room.get({p.x + 1, p.y + 1});
+}
+
+// coordinates, corners, bounding box and area of the polygon. nothing is rasterized.
+bool PuzzleValidator::checkWall(const Polygon& wall, std::string* reason) {
+  auto fail = [&](const char* msg) {
+    if (reason) *reason = msg;
+    return false;
+  };
+  const int n = wall.size();
+  if (n < 4) return fail("too few vertices");
+  int xmin = puzzle.tSize, ymin = puzzle.tSize, xmax = 0, ymax = 0;
+  for (auto p : wall) {
+    if (p.x < 0 || p.y < 0) return fail("negative coordinate");
+    if (p.x > puzzle.tSize) return fail("large W");
+    if (p.y > puzzle.tSize) return fail("large H");
+    xmin = std::min(xmin, p.x);
+    ymin = std::min(ymin, p.y);
     xmax = std::max(xmax, p.x);
     ymax = std::max(ymax, p.y);
   }
-  auto mark_invalid = [&](std::string msg) {
-    std::cerr << msg << std::endl;
-    valid = false;
-  };
+  if (xmax - xmin < min_size) return fail("small W");
+  if (ymax - ymin < min_size) return fail("small H");
 
-  // size.
-  if (xmax > tSize) {
-    mark_invalid("large W");
+  // corners are the points where the direction changes. zero-length edges are skipped.
+  int corners = 0;
+  long long area2 = 0;
+  Point first_dir = {0, 0}, last_dir = {0, 0};
+  for (int i = 0; i < n; ++i) {
+    const Point p = wall[i], q = wall[(i + 1) % n];
+    area2 += static_cast<long long>(p.x) * q.y - static_cast<long long>(q.x) * p.y;
+    if (p.x != q.x && p.y != q.y) return fail("not axis-aligned edge");
+    if (p == q) continue;
+    const Point dir = {(q.x > p.x) - (q.x < p.x), (q.y > p.y) - (q.y < p.y)};
+    if (first_dir == Point{0, 0}) {
+      first_dir = dir;
+    } else if (dir != last_dir) {
+      if (dir == Point{0, 0} - last_dir) return fail("degenerate edge");
+      ++corners;
+    }
+    last_dir = dir;
   }
-  if (ymax > tSize) {
-    mark_invalid("large H");
+  if (last_dir == Point{0, 0} - first_dir) return fail("degenerate edge");
+  if (last_dir != first_dir) ++corners;
+  if (corners < puzzle.vMin || corners < 4) return fail("too few vertices");
+  if (corners > puzzle.vMax) return fail("too many vertices");
+  if (std::abs(area2) < 2LL * min_area) return fail("small area");
+  return true;
+}
+
+// even-odd fill. every vertical edge toggles a bit at its x on its rows, and the rows are prefix-XORed.
+void PuzzleValidator::rasterize(const Polygon& wall) {
+  const int words = room.numWords();
+  for (int y = 0; y < room.height(); ++y) {
+    std::fill(room.row(y), room.row(y) + words, 0);
   }
-  if (xmax < tSize - tSize / 10) {
-    mark_invalid("small W");
+  for (int i = 0; i < wall.size(); ++i) {
+    const Point p = wall[i], q = wall[(i + 1) % wall.size()];
+    if (p.x != q.x) continue;
+    const int x = p.x + 1;
+    const uint64_t bit = uint64_t(1) << (x & 63);
+    for (int y = std::min(p.y, q.y); y < std::max(p.y, q.y); ++y) {
+      room.row(y + 1)[x >> 6] ^= bit;
+    }
   }
-  if (ymax < tSize - tSize / 10) {
-    mark_invalid("small H");
+  for (int y = 1; y + 1 < room.height(); ++y) {
+    uint64_t* r = room.row(y);
+    uint64_t carry = 0;
+    for (int k = 0; k < words; ++k) {
+      uint64_t v = r[k];
+      v ^= v << 1;
+      v ^= v << 2;
+      v ^= v << 4;
+      v ^= v << 8;
+      v ^= v << 16;
+      v ^= v << 32;
+      r[k] = v ^ carry;
+      carry = (r[k] >> 63) ? ~uint64_t(0) : 0;
+    }
   }
-  // fill walls.
-  Map2D map(xmax + 1, ymax + 1, CellType::kObstacleBit);
-  if (!fillPolygon(map, solution.wall, CellType::kEmpty)) {
-    mark_invalid("unable to fill walls");
+}
+
+bool PuzzleValidator::validate(const PuzzleSolution& solution, std::string* reason) {
+  auto fail = [&](const char* msg) {
+    if (reason) *reason = msg;
+    return false;
+  };
+  if (solution.Bs.size() != puzzle.mNum) return fail("booster B size mismatch");
+  if (solution.Fs.size() != puzzle.fNum) return fail("booster F size mismatch");
+  if (solution.Ls.size() != puzzle.dNum) return fail("booster L size mismatch");
+  if (solution.Rs.size() != puzzle.rNum) return fail("booster R size mismatch");
+  if (solution.Cs.size() != puzzle.cNum) return fail("booster C size mismatch");
+  if (solution.Xs.size() != puzzle.xNum) return fail("booster X size mismatch");
+  if (!checkWall(solution.wall, reason)) return false;
+
+  rasterize(solution.wall);
+  // one pass over the 2x2 windows of the padded rows.
+  //   a0 a1   diagonal-only contact: a0 == b1, a1 == b0 and a0 != a1.
+  //   b0 b1   the length of the boundary is counted at the same time.
+  const int words = room.numWords();
+  long long boundary = 0;
+  for (int y = 0; y + 1 < room.height(); ++y) {
+    const uint64_t* ra = room.row(y);
+    const uint64_t* rb = room.row(y + 1);
+    for (int k = 0; k < words; ++k) {
+      const uint64_t a = ra[k], b = rb[k];
+      const uint64_t sa = (a >> 1) | (k + 1 < words ? ra[k + 1] << 63 : 0);
+      const uint64_t sb = (b >> 1) | (k + 1 < words ? rb[k + 1] << 63 : 0);
+      if ((a ^ sa) & (a ^ b) & ~(a ^ sb)) return fail("not 4-connected");
+      boundary += __builtin_popcountll(a ^ sa) + __builtin_popcountll(a ^ b);
+    }
   }
-  // both walls and rooms are 4-connected.
-  if (!isConnected4(map)) {
-    mark_invalid("not 4-connected");
+  // overlapping edges cancel each other in the fill, and the boundary becomes shorter than the polygon.
+  long long perimeter = 0;
+  for (int i = 0; i < solution.wall.size(); ++i) {
+    const Point d = solution.wall[(i + 1) % solution.wall.size()] - solution.wall[i];
+    perimeter += std::abs(d.x) + std::abs(d.y);
   }
-  // area.
-  const int area = countCellsByMask(map, CellType::kObstacleBit, 0);
-  if (area < (tSize * tSize * 2 + 10 - 1) / 10) {
-    mark_invalid("small area");
+  if (boundary != perimeter) return fail("self-overlapping wall");
+  const int area = room.count();
+  if (area < min_area) return fail("small area");
+  const Point seed = solution.wall[0];
+  Point start = {-1, -1};
+  for (Point c : {seed, seed - Point{1, 0}, seed - Point{0, 1}, seed - Point{1, 1}}) {
+    if (isRoom(c)) start = c + Point{1, 1};
   }
-  // in/out
-  for (auto p : iSqs) {
-    if (!map.isInside(p) || (map(p) & CellType::kObstacleBit) != 0) {
-      mark_invalid("inside point is out");
-    }
+  if (start.x < 0 || floodFill(room, start).count() != area) return fail("disconnected room");
+
+  for (auto p : puzzle.iSqs) {
+    if (!isRoom(p)) return fail("inside point is out");
   }
-  for (auto p : oSqs) {
-    if (!map.isInside(p) || (map(p) & CellType::kObstacleBit) == 0) {
-      mark_invalid("outside point is in");
-    }
+  for (auto p : puzzle.oSqs) {
+    if (isRoom(p)) return fail("outside point is in");
   }
-  // polygon vertices.
-  if (solution.wall.size() < vMin) {
-    mark_invalid("too few vertices");
-  }
-  if (solution.wall.size() > vMax) {
-    mark_invalid("too many vertices");
-  }
-  // wrapper pos
-  if (!map.isInside(solution.wrapper) || (map(solution.wrapper) & CellType::kObstacleBit) != 0) {
-    mark_invalid("invalid wrapper pos");
-  }
-  // boosters
-  if (solution.Bs.size() != mNum) { mark_invalid("booster B size mismatch"); }
-  if (solution.Fs.size() != fNum) { mark_invalid("booster F size mismatch"); }
-  if (solution.Ls.size() != dNum) { mark_invalid("booster L size mismatch"); }
-  if (solution.Rs.size() != rNum) { mark_invalid("booster R size mismatch"); }
-  if (solution.Cs.size() != cNum) { mark_invalid("booster C size mismatch"); }
-  if (solution.Xs.size() != xNum) { mark_invalid("booster X size mismatch"); }
-  std::vector<std::vector<Point>> boosters_list = {
-    solution.Bs,
-    solution.Fs,
-    solution.Ls,
-    solution.Rs,
-    solution.Cs,
-    solution.Xs,
+  if (!isRoom(solution.wrapper)) return fail("invalid wrapper pos");
+
+  // boosters are marked in `used`, and the marks are cleared before returning.
+  const std::vector<Point>* boosters_list[] = {
+    &solution.Bs, &solution.Fs, &solution.Ls, &solution.Rs, &solution.Cs, &solution.Xs,
   };
-  std::vector<Point> boosters;
-  for (auto& ls : boosters_list) {
-    for (auto p : ls) {
-      if (std::find(boosters.begin(), boosters.end(), p) != boosters.end()) {
-        mark_invalid("multiple boosters at the same location");
+  const char* error = nullptr;
+  std::vector<Point> marked;
+  for (auto* ls : boosters_list) {
+    for (auto p : *ls) {
+      if (!isRoom(p)) {
+        error = "invalid booster pos";
+        break;
       }
-      if (!map.isInside(p) || (map(p) & CellType::kObstacleBit) != 0) {
-        mark_invalid("invalid booster pos");
+      const Point b = p + Point{1, 1};
+      if (used.get(b)) {
+        error = "multiple boosters at the same location";
+        break;
       }
+      used.set(b);
+      marked.push_back(b);
     }
+    if (error) break;
   }
-  return valid;
+  for (auto b : marked) used.reset(b);
+  return error ? fail(error) : true;
 }
 
 Map2D Puzzle::constraintsToMap() const {
@@ -1,6 +1,8 @@
 #pragma once
+#include <string>
 #include <vector>
 #include "base.h"
+#include "bit_grid.h"
 #include "map2d.h"
 
 struct PuzzleSolution;
@@ -40,6 +42,7 @@ struct Puzzle {
       iSqs == rhs.iSqs &&
       oSqs == rhs.oSqs;
   }
+  // all rules are checked. reasons of the violation are written to std::cerr.
   bool validateSolution(const PuzzleSolution& solution_map) const;
   Map2D constraintsToMap() const;
 };
@@ -57,6 +60,34 @@ struct PuzzleSolution {
   std::string toString() const;
 };
 
+// checks a solution against all rules of the puzzle.
+//  - the wall is a simple rectilinear polygon in [0, tSize]^2. (no crossing, touching nor overlapping edges)
+//  - vMin <= # of corners <= vMax. collinear and duplicated points are not counted.
+//  - width and height of the bounding box >= tSize - floor(0.1 * tSize), area >= ceil(0.2 * tSize^2).
+//  - iSqs are inside and oSqs are outside.
+//  - the wrapper and the boosters are inside, the boosters are at distinct cells and their counts match.
+// the room is rasterized into a padded BitGrid with XOR prefix scans, and the 4-connectivity is checked
+// in one pass of 2x2 windows over the rows. buffers are reused, so keep one validator per thread in search loops.
+class PuzzleValidator {
+public:
+  explicit PuzzleValidator(const Puzzle& puzzle);
+  // returns false at the first violated rule. its reason is stored if reason != nullptr.
+  bool validate(const PuzzleSolution& solution, std::string* reason = nullptr);
+  // cells of the room in the last validated solution. cell (x, y) is at (x + 1, y + 1).
+  const BitGrid& roomBits() const { return room; }
+
+private:
+  bool checkWall(const Polygon& wall, std::string* reason);
+  void rasterize(const Polygon& wall);
+  bool isRoom(Point p) const;
+
+  Puzzle puzzle;
+  int min_size;
+  int min_area;
+  BitGrid room; // (tSize + 2)^2 with empty borders.
+  BitGrid used; // cells with a booster.
+};
+
 Puzzle parsePuzzleCondString(std::string cond_file_str);
 
 // dump constraints map for display. the first row corresponds to the highest y.
@@ -0,0 +1,86 @@
+#include "puzzle_search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+double secondsSinceEpoch() {
+  return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+int scorePuzzleSolution(const PuzzleSolution& solution, const std::string& engine, double deadline) {
+  if (SolverRegistry<SolverFunction>::getRegistry().count(engine) == 0) return -1;
+  SolverFunction solver = SolverRegistry<SolverFunction>::getSolver(engine);
+  Game game(solution.toString());
+  SolverParam param;
+  param.deadline = deadline;
+  // engines keep per-thread counters, so the engine runs on a fresh thread.
+  std::thread([&]() {
+    solver(param, &game, [&](Game*) { return deadline <= 0 || secondsSinceEpoch() < deadline; });
+  }).join();
+  return game.isEnd() ? game.time : -1;
+}
+
+PuzzleSearchResult searchPuzzle(const Puzzle& puzzle, const PuzzleSearchParam& param) {
+  std::vector<std::string> solvers;
+  for (auto& s : param.solvers) {
+    if (SolverRegistry<PuzzleSolverFunction>::getRegistry().count(s) == 0) {
+      std::cerr << "puzzle search: unknown solver " << s << std::endl;
+      continue;
+    }
+    solvers.push_back(s);
+  }
+  PuzzleSearchResult best;
+  if (solvers.empty()) return best;
+  if (!param.score_engine.empty() && SolverRegistry<SolverFunction>::getRegistry().count(param.score_engine) == 0) {
+    std::cerr << "puzzle search: unknown score engine " << param.score_engine << std::endl;
+    return best;
+  }
+
+  std::mutex mutex; // guards best and the log.
+  int best_index = -1;
+  std::atomic<int> next(0);
+  auto work = [&]() {
+    PuzzleValidator validator(puzzle);
+    for (int k; (k = next++) < param.num_candidates;) {
+      if (param.deadline > 0 && secondsSinceEpoch() >= param.deadline) break;
+      const std::string& name = solvers[k % solvers.size()];
+      PuzzleSolverParam solver_param;
+      solver_param.seed = param.seed + k;
+      PuzzleSolution solution = SolverRegistry<PuzzleSolverFunction>::getSolver(name)(solver_param, puzzle);
+      std::string reason;
+      const bool valid = validator.validate(solution, &reason);
+      const int score = valid && !param.score_engine.empty() ? scorePuzzleSolution(solution, param.score_engine, param.deadline) : -1;
+
+      std::lock_guard<std::mutex> lock(mutex);
+      ++best.num_candidates;
+      if (param.verbose) {
+        std::cerr << "puzzle search: #" << k << " " << name << " seed=" << solver_param.seed << " => "
+                  << (valid ? "score " + std::to_string(score) : reason) << std::endl;
+      }
+      if (!valid) continue;
+      ++best.num_valid;
+      if (best.valid && (score < best.score || (score == best.score && best_index < k))) continue;
+      best.valid = true;
+      best.solution = solution;
+      best.score = score;
+      best.solver = name;
+      best.seed = solver_param.seed;
+      best_index = k;
+    }
+  };
+
+  int num_threads = param.num_threads > 0 ? param.num_threads : std::thread::hardware_concurrency();
+  num_threads = std::max(1, std::min(num_threads, param.num_candidates));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) threads.emplace_back(work);
+  for (auto& t : threads) t.join();
+  return best;
+}
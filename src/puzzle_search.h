@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "puzzle.h"
+#include "solver_registry.h"
+
+// multi-start puzzle generation.
+// candidates with different seeds are solved on a thread pool, validated, and scored by a task engine.
+struct PuzzleSearchParam {
+  std::vector<std::string> solvers = {"outBFS"}; // candidate k uses solvers[k % size].
+  int num_candidates = 16;
+  int num_threads = 0;       // 0: std::thread::hardware_concurrency()
+  double deadline = 0;       // seconds since the epoch. no candidate is started after it. 0: no deadline.
+  unsigned seed = 88675123;  // candidate k uses seed + k.
+  std::string score_engine = "bfs2"; // empty: candidates are not scored, and the first valid one wins.
+  bool verbose = false;
+};
+
+struct PuzzleSearchResult {
+  bool valid = false;
+  PuzzleSolution solution;
+  int score = -1;           // time steps of the score engine on the puzzle. larger is harder. -1: not scored.
+  std::string solver;
+  unsigned seed = 0;
+  int num_candidates = 0;   // # of solved candidates.
+  int num_valid = 0;
+};
+
+// time steps of the engine to wrap the map of the solution. -1 if the engine is unknown or it does not finish by the deadline.
+int scorePuzzleSolution(const PuzzleSolution& solution, const std::string& engine, double deadline = 0);
+
+// the hardest valid candidate. ties are broken by the candidate index.
+// nothing is searched (valid = false) if no solver or the score engine is unknown.
+// puzzle solvers can not be interrupted, so a running candidate may outlive the deadline.
+PuzzleSearchResult searchPuzzle(const Puzzle& puzzle, const PuzzleSearchParam& param);
@@ -10,6 +10,7 @@
 #include <vector>
 #include <set>
 #include <cassert>
+#include <random>
 
 #include "puzzle.h"
 #include "fill_polygon.h"
@@ -18,6 +19,7 @@
 #include "solver_helper.h"
 
 PuzzleSolution minimumExcludePuzzleSolver(PuzzleSolverParam param, Puzzle puzzle) {
+  std::mt19937 rng(param.seed);
   int W = 0, H = 0;
   for (auto p : puzzle.iSqs) {
     W = std::max(W, p.x);
@@ -77,62 +79,84 @@ PuzzleSolution minimumExcludePuzzleSolver(PuzzleSolverParam param, Puzzle puzzle
   assert (disjointConnectedComponentsByMask(room_map, 1, 0).size() == 1);
 
   // increase vertices.
-  Polygon fine_polygon;
-  Polygon simple_polygon;
-  while (true) {
-    parsePolygon(fine_polygon, room_map, ROOM);
-    simple_polygon = simplifyPolygon(fine_polygon);
-    const int n_verts = simple_polygon.size();
-    //std::cout << n_verts << " .. " << puzzle.vMin << std::endl;
-    if (n_verts < puzzle.vMin) {
-      // add a pixel to a wall.
-      std::vector<Point> wall_neighbor;
-      for (int y = 0; y < room_map.H; ++y) {
-        for (int x = 0; x < room_map.W; ++x) {
-          // never select from iSqs
-          if (work(x, y) & INCLUDE) continue;
-          // all border points.
-          bool is_wall_neighbor = x == 0 || x + 1 == room_map.W || y == 0 || y + 1 == room_map.H;
-          // or 4-connected to a wall.
-          if (!is_wall_neighbor) {
-            for (auto o : neighbors4) {
-              if (room_map(Point {x, y} + o) == WALL) {
-                is_wall_neighbor = true;
-              }
-            }
-          }
-          if (is_wall_neighbor) {
-            wall_neighbor.push_back({x, y});
-          }
-        }
-      }
-      assert (!wall_neighbor.empty());
+  // a wall pixel is tested only in its 3x3 neighborhood, and the # of corners is updated by the 4 corners of the pixel.
+  // outside of the map is a wall.
+  auto isRoom = [&](int x, int y) {
+    return room_map.isInside(x, y) && room_map(x, y) == ROOM;
+  };
+  // a lattice point is a corner if an odd number of the 4 cells around it are room.
+  auto isCorner = [&](int x, int y) {
+    return (isRoom(x - 1, y - 1) + isRoom(x, y - 1) + isRoom(x - 1, y) + isRoom(x, y)) % 2 == 1;
+  };
+  auto cornersAround = [&](Point p) {
+    return isCorner(p.x, p.y) + isCorner(p.x + 1, p.y) + isCorner(p.x, p.y + 1) + isCorner(p.x + 1, p.y + 1);
+  };
+  // a room pixel can be a wall if the room and the wall remain 4-connected and no diagonal-only contact appears.
+  //   the 8 neighbors in cyclic order have one run of room and one run of wall, and no 2x2 becomes a checkerboard.
+  const Point ring[8] = {{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+  auto canBeWall = [&](Point p) {
+    bool room_bits[8];
+    for (int k = 0; k < 8; ++k) room_bits[k] = isRoom(p.x + ring[k].x, p.y + ring[k].y);
+    int transitions = 0;
+    for (int k = 0; k < 8; ++k) transitions += room_bits[k] != room_bits[(k + 1) % 8];
+    if (transitions != 2) return false;
+    // 2x2 windows containing p: (edge k, diagonal k + 1, edge k + 2) for k = 0, 2, 4, 6. p becomes a wall.
+    for (int k = 0; k < 8; k += 2) {
+      const bool a = room_bits[k], d = room_bits[(k + 1) % 8], b = room_bits[(k + 2) % 8];
+      if (a && b && !d) return false;
+    }
+    return true;
+  };
 
-      // pick random candidate and evaluate.
-      Point new_wall;
-      while (true) {
-        new_wall = wall_neighbor[rand() % wall_neighbor.size()];
-        room_map(new_wall) = WALL;
-        // it divides the map.
-        if (disjointConnectedComponentsByMask(room_map, 1, 0).size() > 1) {
-          room_map(new_wall) = ROOM;
-          continue;
-        }
-        // bad connectivity.
-        if (!isConnected4(room_map)) {
-          room_map(new_wall) = ROOM;
-          continue;
+  int n_corners = 0;
+  for (int y = 0; y <= room_map.H; ++y)
+    for (int x = 0; x <= room_map.W; ++x)
+      n_corners += isCorner(x, y);
+
+  // room pixels next to a wall. stale entries are removed when they are picked.
+  std::vector<Point> wall_neighbor;
+  Map2D in_list(room_map.W, room_map.H, 0);
+  auto addCandidate = [&](Point p) {
+    if (!isRoom(p.x, p.y) || (work(p) & INCLUDE) || in_list(p)) return;
+    in_list(p) = 1;
+    wall_neighbor.push_back(p);
+  };
+  for (int y = 0; y < room_map.H; ++y) {
+    for (int x = 0; x < room_map.W; ++x) {
+      for (auto o : neighbors4) {
+        if (!isRoom(x + o.x, y + o.y)) {
+          addCandidate({x, y});
         }
-        // OK.
-        break;
       }
-      // accept wall.
-      room_map(new_wall) = WALL;
-      work(new_wall) = WALL;
-    } else {
-      break;
     }
   }
+
+  while (n_corners < puzzle.vMin) {
+    assert (!wall_neighbor.empty());
+    // pick random candidate and evaluate.
+    const int i = rng() % wall_neighbor.size();
+    const Point new_wall = wall_neighbor[i];
+    if (!isRoom(new_wall.x, new_wall.y)) {
+      in_list(new_wall) = 0;
+      wall_neighbor[i] = wall_neighbor.back();
+      wall_neighbor.pop_back();
+      continue;
+    }
+    if (!canBeWall(new_wall)) continue;
+    // accept wall.
+    n_corners -= cornersAround(new_wall);
+    room_map(new_wall) = WALL;
+    work(new_wall) = WALL;
+    n_corners += cornersAround(new_wall);
+    for (auto o : neighbors4) {
+      addCandidate(new_wall + o);
+    }
+  }
+
+  Polygon fine_polygon;
+  parsePolygon(fine_polygon, room_map, ROOM);
+  Polygon simple_polygon = simplifyPolygon(fine_polygon);
+  assert (simple_polygon.size() == n_corners);
   std::cerr << room_map.toString(true, true, 1) << std::endl;
 
   PuzzleSolution solution;
@@ -142,8 +166,8 @@ PuzzleSolution minimumExcludePuzzleSolver(PuzzleSolverParam param, Puzzle puzzle
   auto popRandomPlacementPosition = [&]() {
     int x = 0, y = 0;
     do {
-      x = rand() % room_map.W;
-      y = rand() % room_map.H;
+      x = rng() % room_map.W;
+      y = rng() % room_map.H;
     } while (occupiedByPlacement(x, y) || room_map(x, y) != ROOM);
     occupiedByPlacement(x, y) = 1;
     return Point {x, y};
@@ -11,6 +11,7 @@
 
 #include "puzzle.h"
 #include "fill_polygon.h"
+#include "grid_graph.h"
 #include "solver_registry.h"
 
 namespace{
@@ -41,7 +42,7 @@ namespace{
 	double nextDouble() {
 		return double(nextUInt()) / UINT_MAX;
 	}
-} rnd;
+};
 
 }
 
@@ -50,57 +51,26 @@ PuzzleSolution outBFS(PuzzleSolverParam param, Puzzle puzzle)
   int tSize = puzzle.tSize, H = tSize + 2, W = tSize + 2; // 外枠
   auto &iSqs = puzzle.iSqs;
   auto oSqs = puzzle.oSqs;
+  // 経路を伸ばす順番をシードで変える
+  XorShift rnd(param.seed);
+  for(int i = int(oSqs.size()) - 1; i > 0; i--) std::swap(oSqs[i], oSqs[rnd.nextUInt(i + 1)]);
+
+  // 外枠が OUT. 障害物は通れない
+  GridDijkstra bfs(W, H, 1);
+  bfs.setNeighborOrder({{{1, 0}, {0, -1}, {-1, 0}, {0, 1}}}); // 右, 上, 左, 下
+  std::vector<uint8_t> is_out(H * W, 0);
+  for(int i = 0; i < H; i++) for(int j = 0; j < W; j++){
+    if(i == 0 || i == H - 1 || j == 0 || j == W - 1) is_out[i * W + j] = 1;
+  }
+  for(Point p : iSqs) bfs.setWeight(bfs.index({p.x + 1, p.y + 1}), 0);
 
-  const int OUT = 0;
-  const int IN = 1;
-  const int OBSTACLE = 2;
-  std::vector<std::vector<int>> board(H, std::vector<int>(W, 0));
-  for(int i = 1; i <= H - 2; i++) for(int j = 1; j <= W - 2; j++) board[i][j] = IN;
-  for(Point p : iSqs) board[p.y + 1][p.x + 1] = OBSTACLE;
-
-  // OUT までの最短経路
+  // OUT までの最短経路 (探索用のバッファは呼び出し間で使い回される)
   auto getPath = [&](int i, int j) {
-    const int di[] = {0, -1, 0, 1};
-    const int dj[] = {1, 0, -1, 0};
-    std::vector<std::vector<int>> dist(H, std::vector<int>(W, INT_MAX));
-    std::vector<std::vector<bool>> visited(H, std::vector<bool>(W, false));
-    //std::vector<int> dist(H * W, INT_MAX);
-    std::queue<Point> qu;
-    qu.push(Point(j, i));
-    dist[i][j] = 0;
-    while(!qu.empty()){
-      Point p = qu.front(); qu.pop();
-      int i = p.y, j = p.x;
-      for(int d = 0; d < 4; d++){
-        int ni = i + di[d];
-        int nj = j + dj[d];
-        if(ni < 0 || ni >= H || nj < 0 || nj >= W) continue;
-        if(board[ni][nj] == OBSTACLE) continue;
-        if(dist[ni][nj] > dist[i][j] + 1){
-          dist[ni][nj] = dist[i][j] + 1;
-          qu.push(Point(nj, ni));
-        }
-        if(board[ni][nj] == OUT){
-          Polygon poly;
-          int nd = dist[ni][nj];
-          poly.emplace_back(nj, ni);
-          nd--;
-          for(; nd >= 0; nd--){
-            for(int dd = 0; dd < 4; dd++){
-              int nni = ni + di[dd], nnj = nj + dj[dd];
-              if(nni < 0 || nni >= H || nnj < 0 || nnj >= W || dist[nni][nnj] != nd) continue;
-              ni = nni;
-              nj = nnj;
-              poly.emplace_back(nj, ni);
-            }
-          }
-          reverse(poly.begin(), poly.end());
-          //std::cerr << poly.size() << std::endl;
-          return poly;
-        }
-      }
-    }
-    return Polygon();
+    Polygon poly;
+    const int target = bfs.runToAny(bfs.index({j, i}), is_out);
+    if(target < 0) return poly;
+    for(int v : bfs.path(target)) poly.push_back(bfs.point(v));
+    return poly;
   };
 
   // auto dumpBoard = [&](const Map2D& map2d){
@@ -119,21 +89,23 @@ PuzzleSolution outBFS(PuzzleSolverParam param, Puzzle puzzle)
     Polygon path = getPath(i, j);
     //std::cerr << path.size() << std::endl;
     for(Point q : path){
-      board[q.y][q.x] = OUT;
+      is_out[q.y * W + q.x] = 1;
     }
   }
 
   Map2D map2d(tSize, tSize);
   for(int i = 0; i < tSize; i++){
     for(int j = 0; j < tSize; j++){
-      if(board[i + 1][j + 1] != OUT) map2d.data[i * tSize + j] = 1;
+      if(!is_out[(i + 1) * W + j + 1]) map2d.data[i * tSize + j] = 1;
     }
   }
 
   //dumpBoard(map2d);
   
   Polygon fine_polygon;
-  assert(parsePolygon(fine_polygon, map2d, 1));
+  const bool parsed = parsePolygon(fine_polygon, map2d, 1); // not in assert() to run with NDEBUG.
+  assert(parsed);
+  (void)parsed;
   //std::cerr << fine_polygon.size() << std::endl;
   Polygon simple_polygon = simplifyPolygon(fine_polygon);
   //std::cerr << simple_polygon.size() << std::endl;
@@ -14,7 +14,9 @@ PuzzleSolution simpleSolver(PuzzleSolverParam param, Puzzle puzzle) {
     0, 0, R,
   });
   Polygon fine_polygon;
-  assert (parsePolygon(fine_polygon, map2d, R));
+  const bool parsed = parsePolygon(fine_polygon, map2d, R); // not in assert() to run with NDEBUG.
+  assert(parsed);
+  (void)parsed;
   
   PuzzleSolution solution;
   solution.wall = simplifyPolygon(fine_polygon);
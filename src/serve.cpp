@@ -0,0 +1,380 @@
+#include "serve.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "solver_helper.h"
+#include "solver_registry.h"
+
+namespace {
+
+// minimal parser of a flat JSON object. values are kept as strings.
+class FlatJsonParser {
+public:
+  explicit FlatJsonParser(const std::string& s_) : s(s_) {}
+
+  bool parse(std::map<std::string, std::string>& values, std::string& error) {
+    skip();
+    if (!consume('{')) return fail("'{' is expected", error);
+    skip();
+    if (consume('}')) return end(error);
+    while (true) {
+      std::string key, value;
+      skip();
+      if (!parseString(key)) return fail("a key is expected", error);
+      skip();
+      if (!consume(':')) return fail("':' is expected", error);
+      skip();
+      if (peek() == '"') {
+        if (!parseString(value)) return fail("broken string", error);
+      } else {
+        while (i < s.size() && (std::isalnum(s[i]) || s[i] == '.' || s[i] == '-' || s[i] == '+')) value.push_back(s[i++]);
+        if (value.empty()) return fail("a value is expected", error);
+        if (value == "null") value.clear();
+      }
+      values[key] = value;
+      skip();
+      if (consume('}')) return end(error);
+      if (!consume(',')) return fail("',' or '}' is expected", error);
+    }
+  }
+
+private:
+  char peek() const { return i < s.size() ? s[i] : '\0'; }
+  bool consume(char c) {
+    if (peek() != c) return false;
+    ++i;
+    return true;
+  }
+  void skip() {
+    while (i < s.size() && std::isspace(s[i])) ++i;
+  }
+  bool parseString(std::string& out) {
+    if (!consume('"')) return false;
+    while (i < s.size() && s[i] != '"') {
+      char c = s[i++];
+      if (c == '\\') {
+        if (i >= s.size()) return false;
+        c = s[i++];
+        switch (c) {
+        case 'n': c = '\n'; break;
+        case 't': c = '\t'; break;
+        case 'r': c = '\r'; break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'u': {
+          // only ASCII is expected in jobs.
+          if (i + 4 > s.size()) return false;
+          int code = 0;
+          for (int k = 0; k < 4; ++k) {
+            const char h = s[i++];
+            if (!std::isxdigit(h)) return false;
+            code = code * 16 + (std::isdigit(h) ? h - '0' : std::tolower(h) - 'a' + 10);
+          }
+          c = static_cast<char>(code);
+          break;
+        }
+        default: break; // '"', '\\', '/'
+        }
+      }
+      out.push_back(c);
+    }
+    return consume('"');
+  }
+  bool end(std::string& error) {
+    skip();
+    return i == s.size() || fail("garbage after the object", error);
+  }
+  bool fail(const std::string& message, std::string& error) {
+    error = message + " at " + std::to_string(i);
+    return false;
+  }
+
+  const std::string& s;
+  int i = 0;
+};
+
+std::string quote(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    switch (c) {
+    case '"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\n': out += "\\n"; break;
+    case '\t': out += "\\t"; break;
+    case '\r': out += "\\r"; break;
+    default: out.push_back(c); break;
+    }
+  }
+  return out + "\"";
+}
+
+std::string errorResult(const std::string& id, const std::string& error) {
+  return "{\"id\":" + quote(id) + ",\"ok\":false,\"error\":" + quote(error) + "}";
+}
+
+double secondsSinceEpoch() {
+  return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+bool parseServeJob(const std::string& line, ServeJob& job, std::string& error) {
+  std::map<std::string, std::string> values;
+  if (!FlatJsonParser(line).parse(values, error)) return false;
+  try {
+    for (auto& kv : values) {
+      if (kv.first == "id") job.id = kv.second;
+      else if (kv.first == "desc") job.desc_path = kv.second;
+      else if (kv.first == "desc_str") job.desc = kv.second;
+      else if (kv.first == "engine") job.engine = kv.second;
+      else if (kv.first == "buy") job.buy = kv.second;
+      else if (kv.first == "time_limit") job.time_limit_s = kv.second.empty() ? 0 : std::stod(kv.second);
+      else if (kv.first == "deadline") job.deadline = kv.second.empty() ? 0 : std::stod(kv.second);
+      else if (kv.first == "restarts") job.num_restarts = kv.second.empty() ? 0 : std::stoi(kv.second);
+      else if (kv.first == "seed") job.seed = kv.second.empty() ? 3333 : std::stoul(kv.second);
+      else {
+        error = "unknown key " + kv.first;
+        return false;
+      }
+    }
+  } catch (const std::exception&) {
+    error = "bad number";
+    return false;
+  }
+  if (job.engine.empty()) {
+    error = "no engine";
+    return false;
+  }
+  if (job.desc_path.empty() == job.desc.empty()) {
+    error = "either desc or desc_str is needed";
+    return false;
+  }
+  if (job.buy.find_first_not_of("BFLRC") != std::string::npos) {
+    error = "bad buy " + job.buy;
+    return false;
+  }
+  return true;
+}
+
+constexpr int ServeWorkspace::kMaxGames;
+
+const Game* ServeWorkspace::find(const std::string& path) {
+  auto it = std::find_if(games.begin(), games.end(), [&](const std::pair<std::string, std::unique_ptr<Game>>& g) {
+    return g.first == path;
+  });
+  if (it == games.end()) return nullptr;
+  games.splice(games.begin(), games, it);
+  return games.front().second.get();
+}
+
+const Game* ServeWorkspace::add(const std::string& path, std::unique_ptr<Game> game) {
+  if (games.size() >= kMaxGames) games.pop_back();
+  games.emplace_front(path, std::move(game));
+  return games.front().second.get();
+}
+
+std::string runServeJob(const ServeJob& job, ServeWorkspace& workspace) {
+  const double t0 = secondsSinceEpoch();
+  if (SolverRegistry<SolverFunction>::getRegistry().count(job.engine) == 0) {
+    return errorResult(job.id, "unknown engine " + job.engine);
+  }
+
+  std::unique_ptr<Game> game;
+  if (!job.desc_path.empty()) {
+    const Game* cached = workspace.find(job.desc_path);
+    if (!cached) {
+      std::ifstream ifs(job.desc_path);
+      if (!ifs) {
+        return errorResult(job.id, "can not read " + job.desc_path);
+      }
+      std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+      std::string error;
+      if (!isValidDescString(str, &error)) {
+        return errorResult(job.id, "broken desc: " + error);
+      }
+      cached = workspace.add(job.desc_path, std::unique_ptr<Game>(new Game(str)));
+    }
+    game.reset(new Game(*cached));
+  } else {
+    std::string error;
+    if (!isValidDescString(job.desc, &error)) {
+      return errorResult(job.id, "broken desc: " + error);
+    }
+    game.reset(new Game(job.desc));
+  }
+  if (!job.buy.empty()) {
+    game->buyBoosters(Buy(job.buy));
+  }
+
+  SolverParam param;
+  param.time_limit_s = job.time_limit_s;
+  param.deadline = job.deadline;
+  if (param.time_limit_s > 0) {
+    param.deadline = param.hasDeadline() ? std::min(param.deadline, t0 + param.time_limit_s) : t0 + param.time_limit_s;
+  }
+  param.num_restarts = job.num_restarts;
+  param.seed = job.seed;
+
+  // engines keep per-thread state, so every job is solved on a fresh thread.
+  SolverFunction solver = SolverRegistry<SolverFunction>::getSolver(job.engine);
+  std::thread([&]() {
+    if (param.num_restarts > 0) {
+      restartSolver(param, game.get(), nullptr, param.num_restarts,
+        [&](SolverParam p, Game* g, SolverIterCallback callback, int) { return solver(p, g, callback); });
+    } else {
+      solver(param, game.get(), nullptr);
+    }
+  }).join();
+
+  if (!game->isEnd()) {
+    return errorResult(job.id, "some cells are not wrapped");
+  }
+  std::ostringstream oss;
+  oss << "{\"id\":" << quote(job.id)
+      << ",\"ok\":true"
+      << ",\"time_unit\":" << game->time
+      << ",\"solution\":" << quote(game->getCommand())
+      << ",\"elapsed\":" << secondsSinceEpoch() - t0 << "}";
+  return oss.str();
+}
+
+JobServer::JobServer(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max<int>(1, std::thread::hardware_concurrency());
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    workers.emplace_back(&JobServer::work, this);
+  }
+}
+
+JobServer::~JobServer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  cv.notify_all();
+  for (auto& w : workers) w.join();
+}
+
+void JobServer::submit(const std::string& line, Reply reply) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.emplace_back(line, std::move(reply));
+  }
+  cv.notify_all();
+}
+
+void JobServer::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&]() { return queue.empty() && num_running == 0; });
+}
+
+void JobServer::work() {
+  ServeWorkspace workspace;
+  while (true) {
+    std::pair<std::string, Reply> item;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&]() { return stopping || !queue.empty(); });
+      if (queue.empty()) return;
+      item = std::move(queue.front());
+      queue.pop_front();
+      ++num_running;
+    }
+
+    ServeJob job;
+    std::string error;
+    item.second(parseServeJob(item.first, job, error) ? runServeJob(job, workspace) : errorResult(job.id, error));
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      --num_running;
+    }
+    cv.notify_all();
+  }
+}
+
+void serveStream(std::istream& in, std::ostream& out, int num_threads) {
+  JobServer server(num_threads);
+  std::mutex out_mutex;
+  for (std::string line; std::getline(in, line);) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    server.submit(line, [&](const std::string& result) {
+      std::lock_guard<std::mutex> lock(out_mutex);
+      out << result << std::endl;
+    });
+  }
+  server.wait();
+}
+
+namespace {
+
+// a client connection. it is closed when the reader and all replies are done.
+struct Connection {
+  explicit Connection(int fd_) : fd(fd_) {}
+  ~Connection() { close(fd); }
+
+  void write(const std::string& line) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::string data = line + "\n";
+    for (size_t sent = 0; sent < data.size();) {
+      const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) return; // the client is gone.
+      sent += n;
+    }
+  }
+
+  int fd;
+  std::mutex mutex;
+};
+
+} // namespace
+
+bool serveUnixSocket(const std::string& path, int num_threads) {
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) return false;
+  const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) return false;
+  std::copy(path.begin(), path.end(), addr.sun_path);
+  unlink(path.c_str());
+  if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd, 16) < 0) {
+    close(listen_fd);
+    return false;
+  }
+
+  JobServer server(num_threads);
+  while (true) {
+    const int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      // EMFILE などは接続が閉じられるまで続くので、空回りせずに待つ。
+      if (errno != EINTR && errno != ECONNABORTED) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+      continue;
+    }
+    auto connection = std::make_shared<Connection>(fd);
+    std::thread([&server, connection]() {
+      std::string buffer;
+      char chunk[4096];
+      for (ssize_t n; (n = recv(connection->fd, chunk, sizeof(chunk), 0)) > 0;) {
+        buffer.append(chunk, n);
+        for (size_t eol; (eol = buffer.find('\n')) != std::string::npos;) {
+          const std::string line = buffer.substr(0, eol);
+          buffer.erase(0, eol + 1);
+          if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+          server.submit(line, [connection](const std::string& result) { connection->write(result); });
+        }
+      }
+    }).detach();
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game.h"
+
+// resident solver. jobs and results are JSON objects, one per line.
+//   job:    {"id":"1", "desc":"prob-001.desc" or "desc_str":"(0,0),...", "engine":"bfs2",
+//            "buy":"BC", "time_limit":10, "deadline":1561939200, "restarts":4, "seed":3333}
+//   result: {"id":"1", "ok":true, "time_unit":123, "solution":"WDD...", "elapsed":0.12}
+//           {"id":"1", "ok":false, "error":"unknown engine"}
+// results are written in the order of completion.
+struct ServeJob {
+  std::string id;
+  std::string desc_path;
+  std::string desc;
+  std::string engine;
+  std::string buy;
+  double time_limit_s = 0;
+  double deadline = 0;
+  int num_restarts = 0;
+  unsigned seed = 3333;
+};
+
+// parse a job line. returns false with the reason if it is not a valid job.
+bool parseServeJob(const std::string& line, ServeJob& job, std::string& error);
+
+// state kept by a worker thread between jobs.
+// only parsed *.desc files are reused. engine state is deliberately not reused: engines keep per-thread
+// state, and every job runs on a fresh std::thread in runServeJob(), so nothing else outlives a job.
+struct ServeWorkspace {
+  static constexpr int kMaxGames = 16;
+  // the initial game of the path, or nullptr if it is not cached. it becomes the most recently used one.
+  const Game* find(const std::string& path);
+  // cache a game. the least recently used one is dropped if kMaxGames games are cached.
+  const Game* add(const std::string& path, std::unique_ptr<Game> game);
+
+  // initial games parsed from *.desc files, the most recently used one first. (key: path)
+  std::list<std::pair<std::string, std::unique_ptr<Game>>> games;
+};
+
+// solve a job and return the result line. (without '\n')
+std::string runServeJob(const ServeJob& job, ServeWorkspace& workspace);
+
+class JobServer {
+public:
+  using Reply = std::function<void(const std::string&)>;
+  explicit JobServer(int num_threads); // 0: all cores
+  ~JobServer(); // waits for the submitted jobs.
+
+  // the reply is called from a worker thread.
+  void submit(const std::string& line, Reply reply);
+  void wait();
+
+private:
+  void work();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::pair<std::string, Reply>> queue;
+  int num_running = 0;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+};
+
+// serve jobs from `in` and write results to `out` until EOF.
+void serveStream(std::istream& in, std::ostream& out, int num_threads);
+// serve jobs on a Unix domain socket. results go back to the connection of the job. returns false on error.
+bool serveUnixSocket(const std::string& path, int num_threads);
@@ -0,0 +1,133 @@
+#include "solution.h"
+
+#include <cassert>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+// parse "X(x,y)".
+bool parseTokenPoint(const std::string& token, Point& p) {
+  if (token.size() < 6 || token[1] != '(' || token.back() != ')') return false;
+  std::istringstream iss(token.substr(2, token.size() - 3));
+  char comma = 0;
+  if (!(iss >> p.x >> comma >> p.y) || comma != ',') return false;
+  return iss.eof() || (iss >> std::ws).eof();
+}
+
+} // namespace
+
+SolutionCommands parseSolutionString(const std::string& solution) {
+  SolutionCommands commands(1);
+  for (int i = 0; i < solution.size(); ++i) {
+    const char c = solution[i];
+    if (std::isspace(c)) continue;
+    if (c == '#') {
+      commands.emplace_back();
+      continue;
+    }
+    std::string token(1, c);
+    if ((c == 'B' || c == 'T') && i + 1 < solution.size() && solution[i + 1] == '(') {
+      const auto close = solution.find(')', i);
+      token = solution.substr(i, close == std::string::npos ? std::string::npos : close - i + 1);
+      i += token.size() - 1;
+    }
+    commands.back().push_back(token);
+  }
+  return commands;
+}
+
+std::string solutionToString(const SolutionCommands& commands) {
+  std::string result;
+  for (int i = 0; i < commands.size(); ++i) {
+    if (i > 0) result.push_back('#');
+    for (auto& token : commands[i]) {
+      result += token;
+    }
+  }
+  return result;
+}
+
+bool applyCommandToken(Wrapper* w, const std::string& token) {
+  Game* game = w->game;
+  if (token.empty()) return false;
+  const char c = token[0];
+  if (token.size() > 1 && c != 'B' && c != 'T') return false;
+  switch (c) {
+  case Action::UP:
+  case Action::DOWN:
+  case Action::LEFT:
+  case Action::RIGHT:
+    if (!w->isMoveable(c)) return false;
+    return w->move(c);
+  case 'Z':
+    w->nop();
+    return true;
+  case Action::CW:
+  case Action::CCW:
+    w->turn(c);
+    return true;
+  case Action::FAST:
+  case Action::DRILL:
+    if (game->num_boosters[boosterFromChar(c).booster_type] <= 0) return false;
+    return w->useBooster(c);
+  case Action::BEACON:
+    if (game->num_boosters[BoosterType::TELEPORT] <= 0) return false;
+    if (game->map2d(w->pos) & CellType::kTeleportTargetBit) return false;
+    return w->useBooster(c);
+  case Action::CLONE:
+    if (game->num_boosters[BoosterType::CLONING] <= 0) return false;
+    if ((game->map2d(w->pos) & CellType::kSpawnPointBit) == 0) return false;
+    return w->cloneWrapper() != nullptr;
+  case 'B': {
+    Point p;
+    if (!parseTokenPoint(token, p)) return false;
+    if (game->num_boosters[BoosterType::MANIPULATOR] <= 0 || !w->canAddManipulator(p)) return false;
+    return w->addManipulator(p);
+  }
+  case 'T': {
+    Point p;
+    if (!parseTokenPoint(token, p)) return false;
+    if (!game->map2d.isInside(p) || (game->map2d(p) & CellType::kTeleportTargetBit) == 0) return false;
+    return w->teleport(p);
+  }
+  }
+  return false;
+}
+
+namespace {
+
+bool replay(Game* game, const SolutionCommands& commands, const ReplayObserver& before_command, int end_time) {
+  std::vector<int> next(commands.size(), 0);
+  while (end_time < 0 || game->time < end_time) {
+    bool remaining = false;
+    for (int i = 0; i < game->wrappers.size() && i < commands.size(); ++i) {
+      remaining = remaining || next[i] < commands[i].size();
+    }
+    if (!remaining) break;
+
+    // wrappers cloned in this time step start at the next one.
+    const int num_wrappers = game->wrappers.size();
+    for (int i = 0; i < num_wrappers; ++i) {
+      Wrapper* w = game->wrappers[i].get();
+      if (i >= commands.size() || next[i] >= commands[i].size()) {
+        w->nop();
+      } else {
+        if (before_command) before_command(*w, next[i]);
+        if (!applyCommandToken(w, commands[i][next[i]++])) return false;
+      }
+    }
+    game->tick();
+  }
+  return end_time >= 0 || game->wrappers.size() >= commands.size();
+}
+
+} // namespace
+
+bool replaySolution(Game* game, const SolutionCommands& commands, const ReplayObserver& before_command) {
+  return replay(game, commands, before_command, -1);
+}
+
+bool replaySolutionUntil(Game* game, const SolutionCommands& commands, int end_time) {
+  return replay(game, commands, nullptr, end_time);
+}
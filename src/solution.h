@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+// a solution split into command tokens. commands[i][k] is the k-th action of the wrapper i.
+// a token is one of W, S, A, D, Z, E, Q, F, L, R, C, B(x,y) and T(x,y).
+using SolutionCommands = std::vector<std::vector<std::string>>;
+
+// parse *.sol string. (wrappers are separated by '#')
+SolutionCommands parseSolutionString(const std::string& solution);
+std::string solutionToString(const SolutionCommands& commands);
+
+// execute a token on the wrapper after checking that it is valid in the current state.
+// returns false (and does nothing) if the token is malformed or not executable.
+bool applyCommandToken(Wrapper* w, const std::string& token);
+
+// replay commands from the current state of game. wrappers without remaining commands wait (Z).
+// returns false if any command is not executable or commands are left for unspawned wrappers.
+// it does not check that all cells are wrapped. use game->isEnd().
+// before_command(w, k) is called before executing commands[w.index][k] if given.
+using ReplayObserver = std::function<void(const Wrapper&, int)>;
+bool replaySolution(Game* game, const SolutionCommands& commands, const ReplayObserver& before_command = nullptr);
+// replay commands until game->time reaches end_time. (the prefix of the solution)
+bool replaySolutionUntil(Game* game, const SolutionCommands& commands, int end_time);
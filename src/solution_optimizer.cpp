@@ -0,0 +1,337 @@
+#include "solution_optimizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Score {
+  bool valid = false;
+  int time = 0;
+  int num_commands = 0;
+};
+
+// a is strictly better than b.
+bool isBetter(const Score& a, const Score& b) {
+  if (!a.valid) return false;
+  if (!b.valid) return true;
+  return a.time < b.time || (a.time == b.time && a.num_commands < b.num_commands);
+}
+
+int countCommands(const SolutionCommands& commands) {
+  int n = 0;
+  for (auto& c : commands) n += c.size();
+  return n;
+}
+
+Score evaluate(const Game& initial, const SolutionCommands& commands) {
+  Game game(initial);
+  Score score;
+  score.valid = replaySolution(&game, commands) && game.isEnd();
+  score.time = game.time;
+  score.num_commands = countCommands(commands);
+  return score;
+}
+
+// replace commands[wrapper][begin, end) by replacement.
+struct Edit {
+  int wrapper;
+  int begin;
+  int end;
+  std::vector<std::string> replacement;
+};
+
+SolutionCommands applyEdit(const SolutionCommands& commands, const Edit& edit) {
+  SolutionCommands result = commands;
+  auto& c = result[edit.wrapper];
+  c.erase(c.begin() + edit.begin, c.begin() + edit.end);
+  c.insert(c.begin() + edit.begin, edit.replacement.begin(), edit.replacement.end());
+  return result;
+}
+
+class Optimizer {
+public:
+  Optimizer(const Game& initial_, const OptimizerParam& param_)
+    : initial(initial_), param(param_) {
+    num_threads = param.num_threads > 0 ? param.num_threads : std::thread::hardware_concurrency();
+    num_threads = std::max(num_threads, 1);
+    deadline = Clock::now() + std::chrono::milliseconds(static_cast<long long>(param.time_limit_s * 1000));
+  }
+
+  SolutionCommands run(SolutionCommands commands);
+
+private:
+  bool timeout() const { return Clock::now() >= deadline; }
+
+  // evaluate each edit applied to base independently. (in parallel)
+  std::vector<Score> evaluateEdits(const SolutionCommands& base, const std::vector<Edit>& edits) const;
+  // apply edits which improve current one by one. returns true if any is applied.
+  bool applyImprovingEdits(std::vector<Edit> edits);
+
+  void trimTrailingNops();
+  bool removeRedundantCommands();
+  bool retimeManipulators();
+  bool replanWindows();
+
+  const Game& initial;
+  const OptimizerParam& param;
+  int num_threads;
+  Clock::time_point deadline;
+
+  SolutionCommands current;
+  Score current_score;
+};
+
+std::vector<Score> Optimizer::evaluateEdits(const SolutionCommands& base, const std::vector<Edit>& edits) const {
+  std::vector<Score> scores(edits.size());
+  std::atomic<int> next(0);
+  auto worker = [&]() {
+    for (int i; (i = next++) < edits.size();) {
+      if (timeout()) break;
+      scores[i] = evaluate(initial, applyEdit(base, edits[i]));
+    }
+  };
+  const int n = std::min<int>(num_threads, edits.size());
+  std::vector<std::thread> threads;
+  for (int t = 1; t < n; ++t) threads.emplace_back(worker);
+  worker();
+  for (auto& t : threads) t.join();
+  return scores;
+}
+
+bool Optimizer::applyImprovingEdits(std::vector<Edit> edits) {
+  const std::vector<Score> scores = evaluateEdits(current, edits);
+  std::vector<Edit> improving;
+  for (int i = 0; i < edits.size(); ++i) {
+    if (isBetter(scores[i], current_score)) improving.push_back(edits[i]);
+  }
+  if (improving.empty()) return false;
+
+  // from the back of each wrapper so that indices of remaining edits stay valid.
+  std::sort(improving.begin(), improving.end(), [](const Edit& a, const Edit& b) {
+    return a.wrapper != b.wrapper ? a.wrapper < b.wrapper : a.begin > b.begin;
+  });
+  std::vector<Edit> disjoint;
+  for (auto& e : improving) {
+    if (!disjoint.empty() && disjoint.back().wrapper == e.wrapper && e.end > disjoint.back().begin) continue;
+    disjoint.push_back(e);
+  }
+
+  // edits are usually independent. try all at once first.
+  SolutionCommands all = current;
+  for (auto& e : disjoint) all = applyEdit(all, e);
+  Score all_score = evaluate(initial, all);
+  if (isBetter(all_score, current_score)) {
+    current = std::move(all);
+    current_score = all_score;
+    return true;
+  }
+
+  bool improved = false;
+  for (auto& e : disjoint) {
+    if (timeout()) break;
+    SolutionCommands candidate = applyEdit(current, e);
+    Score score = evaluate(initial, candidate);
+    if (isBetter(score, current_score)) {
+      current = std::move(candidate);
+      current_score = score;
+      improved = true;
+    }
+  }
+  return improved;
+}
+
+// trailing Z are the same as finishing earlier.
+void Optimizer::trimTrailingNops() {
+  for (auto& c : current) {
+    while (!c.empty() && c.back() == "Z") c.pop_back();
+  }
+  current_score = evaluate(initial, current);
+}
+
+bool isOpposite(const std::string& a, const std::string& b) {
+  static const std::vector<std::pair<std::string, std::string>> pairs = {
+    {"W", "S"}, {"S", "W"}, {"A", "D"}, {"D", "A"}, {"E", "Q"}, {"Q", "E"},
+  };
+  return std::find(pairs.begin(), pairs.end(), std::make_pair(a, b)) != pairs.end();
+}
+
+bool Optimizer::removeRedundantCommands() {
+  std::vector<Edit> edits;
+  for (int w = 0; w < current.size(); ++w) {
+    const auto& c = current[w];
+    for (int k = 0; k < c.size(); ++k) {
+      if (c[k] == "Z") edits.push_back({w, k, k + 1, {}});
+      if (k + 1 < c.size() && isOpposite(c[k], c[k + 1])) edits.push_back({w, k, k + 2, {}});
+    }
+  }
+  return applyImprovingEdits(edits);
+}
+
+// attach manipulators earlier. B is not moved across turns since its offset depends on the direction.
+bool Optimizer::retimeManipulators() {
+  bool improved = false;
+  for (int w = 0; w < current.size(); ++w) {
+    for (int k = 0; k < current[w].size() && !timeout(); ++k) {
+      const auto& c = current[w];
+      if (c[k][0] != 'B') continue;
+      std::vector<Edit> edits;
+      for (int d = 1; d <= param.window && d <= k; ++d) {
+        if (c[k - d][0] == 'E' || c[k - d][0] == 'Q' || c[k - d][0] == 'B') break;
+        if ((d & (d - 1)) != 0) continue; // try 1, 2, 4, ...
+        Edit e { w, k - d, k + 1, {} };
+        e.replacement.push_back(c[k]);
+        e.replacement.insert(e.replacement.end(), c.begin() + k - d, c.begin() + k);
+        edits.push_back(e);
+      }
+      const std::vector<Score> scores = evaluateEdits(current, edits);
+      for (int i = edits.size() - 1; i >= 0; --i) {
+        if (scores[i].valid && scores[i].time <= current_score.time) {
+          improved = improved || scores[i].time < current_score.time;
+          current = applyEdit(current, edits[i]);
+          current_score = scores[i];
+          break;
+        }
+      }
+    }
+  }
+  return improved;
+}
+
+struct Pose {
+  Point pos;
+  Direction dir;
+  bool normal_speed; // neither fast wheels nor drill is active.
+};
+
+// shortest commands from (from, from_dir) to (to, to_dir) not longer than max_len.
+// cells are passable if they are not obstacles in the map.
+bool findShortestPosePath(const Map2D& map, Pose from, Pose to, int max_len, std::vector<std::string>& path) {
+  if (max_len < 0 || std::abs(to.pos.x - from.pos.x) + std::abs(to.pos.y - from.pos.y) > max_len) return false;
+  const int L = max_len;
+  const int S = 2 * L + 1;
+  auto index = [&](Point p, Direction d) {
+    return (((p.y - from.pos.y + L) * S) + (p.x - from.pos.x + L)) * 4 + static_cast<int>(d);
+  };
+  struct Prev { int index; char command; };
+  std::vector<Prev> prev(S * S * 4, Prev { -2, 0 });
+  std::vector<std::pair<Point, Direction>> que;
+  que.push_back({from.pos, from.dir});
+  prev[index(from.pos, from.dir)] = { -1, 0 };
+  static const std::vector<std::pair<char, Point>> moves = {
+    {Action::UP, {0, 1}}, {Action::DOWN, {0, -1}}, {Action::LEFT, {-1, 0}}, {Action::RIGHT, {1, 0}},
+  };
+  for (int head = 0, depth = 0; head < que.size() && depth < max_len; ++depth) {
+    const int tail = que.size();
+    for (; head < tail; ++head) {
+      const Point p = que[head].first;
+      const Direction d = que[head].second;
+      const int i = index(p, d);
+      auto push = [&](Point np, Direction nd, char command) {
+        const int j = index(np, nd);
+        if (prev[j].index != -2) return;
+        prev[j] = { i, command };
+        que.push_back({np, nd});
+      };
+      for (auto& m : moves) {
+        const Point np = p + m.second;
+        if (std::abs(np.x - from.pos.x) > L || std::abs(np.y - from.pos.y) > L) continue;
+        if (!map.isInside(np) || (map(np) & CellType::kObstacleBit)) continue;
+        push(np, d, m.first);
+      }
+      push(p, turnCW(d), Action::CW);
+      push(p, turnCCW(d), Action::CCW);
+    }
+    if (prev[index(to.pos, to.dir)].index != -2) break;
+  }
+  int j = index(to.pos, to.dir);
+  if (prev[j].index == -2) return false;
+  path.clear();
+  for (; prev[j].index >= 0; j = prev[j].index) {
+    path.push_back(std::string(1, prev[j].command));
+  }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
+
+bool Optimizer::replanWindows() {
+  // poses[w][k]: the pose before commands[w][k]. poses[w].back() is the final pose.
+  std::vector<std::vector<Pose>> poses(current.size());
+  Game game(initial);
+  replaySolution(&game, current, [&](const Wrapper& w, int k) {
+    poses[w.index].resize(k);
+    poses[w.index].push_back({w.pos, w.direction, w.time_fast_wheels == 0 && w.time_drill == 0});
+  });
+  for (int w = 0; w < current.size() && w < game.wrappers.size(); ++w) {
+    const Wrapper& wrapper = *game.wrappers[w];
+    poses[w].resize(current[w].size());
+    poses[w].push_back({wrapper.pos, wrapper.direction, wrapper.time_fast_wheels == 0 && wrapper.time_drill == 0});
+  }
+
+  std::vector<Edit> edits;
+  const int stride = std::max(1, param.window / 2);
+  for (int w = 0; w < current.size(); ++w) {
+    const auto& c = current[w];
+    for (int s = 0; s < c.size(); s += stride) {
+      // the longest plain span from s.
+      int e = s;
+      while (e < c.size() && e - s < param.window && poses[w][e].normal_speed &&
+             std::string("WSADEQZ").find(c[e][0]) != std::string::npos) ++e;
+      if (e == c.size()) {
+        // nothing is needed after the span except wrapping.
+        edits.push_back({w, s, e, {}});
+        continue;
+      }
+      for (; e - s >= 2; --e) {
+        std::vector<std::string> path;
+        if (findShortestPosePath(initial.map2d, poses[w][s], poses[w][e], e - s - 1, path)) {
+          edits.push_back({w, s, e, path});
+          break;
+        }
+      }
+    }
+  }
+  return applyImprovingEdits(edits);
+}
+
+SolutionCommands Optimizer::run(SolutionCommands commands) {
+  current = std::move(commands);
+  current_score = evaluate(initial, current);
+  if (!current_score.valid) {
+    std::cerr << "optimize: the input solution is invalid or incomplete." << std::endl;
+    return current;
+  }
+  const Score input_score = current_score;
+  trimTrailingNops();
+  assert (current_score.valid);
+
+  for (int pass = 0; !timeout(); ++pass) {
+    const Score before = current_score;
+    bool improved = removeRedundantCommands();
+    improved = retimeManipulators() || improved;
+    improved = replanWindows() || improved;
+    if (param.verbose) {
+      std::cerr << "optimize: pass " << pass << " time " << before.time << " -> " << current_score.time
+                << " commands " << before.num_commands << " -> " << current_score.num_commands << std::endl;
+    }
+    if (!improved) break;
+  }
+  if (param.verbose) {
+    std::cerr << "optimize: time " << input_score.time << " -> " << current_score.time << std::endl;
+  }
+  return current;
+}
+
+} // namespace
+
+SolutionCommands optimizeSolution(const Game& initial, const SolutionCommands& commands, const OptimizerParam& param) {
+  Optimizer optimizer(initial, param);
+  return optimizer.run(commands);
+}
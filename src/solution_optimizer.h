@@ -0,0 +1,18 @@
+#pragma once
+
+#include "game.h"
+#include "solution.h"
+
+struct OptimizerParam {
+  int window = 16;           // max # of commands re-planned at once.
+  int num_threads = 0;       // 0: std::thread::hardware_concurrency()
+  double time_limit_s = 60.0;
+  bool verbose = false;
+};
+
+// shorten a solution by local search. every edit is verified by replaying the whole solution
+// from `initial` and checking that all cells are wrapped. an invalid input is returned as is.
+//  - remove Z and back-and-forth pairs (WS, AD, EQ, ...)
+//  - use B(x,y) earlier
+//  - replace a span of W/S/A/D/E/Q/Z by a shorter path between the same poses
+SolutionCommands optimizeSolution(const Game& initial, const SolutionCommands& commands, const OptimizerParam& param);
@@ -1,12 +1,24 @@
 #include "solver_helper.h"
 #include <iostream>
 #include <cassert>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <thread>
 #include <queue>
+#include <unordered_map>
+#include "manipulator_reach.h"
+#include "trajectory.h"
 #include "solver_utils.h"
+#include "bit_grid.h"
 
 std::string wrapperEngineSolver(SolverParam param, Game* game, SolverIterCallback iter_callback, WrapperEngineBase::Ptr prototype) {
   std::vector<WrapperEngineBase::Ptr> engines;
-  engines.emplace_back(prototype->create(game, game->wrappers[0].get()));
+  for (auto& w : game->wrappers) { // more than one if resumed from a checkpoint.
+    engines.emplace_back(prototype->create(game, w.get()));
+  }
 
   while (!game->isEnd()) {
     std::vector<int> cloned_ids;
@@ -45,6 +57,108 @@ std::string functorSolver(SolverParam param, Game* game, SolverIterCallback iter
   return game->getCommand();
 
 }
+void SolverRandom::seed(unsigned seed) {
+  state[0] = seed == 0 ? 1 : seed;
+  for (int i = 1; i < 31; ++i) {
+    // 16807 * state[i - 1] % 2147483647 without overflow.
+    const std::int64_t hi = state[i - 1] / 127773;
+    const std::int64_t lo = state[i - 1] % 127773;
+    std::int64_t word = 16807 * lo - 2836 * hi;
+    if (word < 0) word += 2147483647;
+    state[i] = word;
+  }
+  front = 3;
+  rear = 0;
+  for (int i = 0; i < 310; ++i) (*this)();
+}
+
+SolverRandom::result_type SolverRandom::operator()() {
+  const std::uint32_t value = std::uint32_t(state[front]) + std::uint32_t(state[rear]);
+  state[front] = value;
+  front = front + 1 < 31 ? front + 1 : 0;
+  rear = rear + 1 < 31 ? rear + 1 : 0;
+  return value >> 1;
+}
+
+namespace {
+thread_local SolverRandom t_solver_random;
+}
+
+SolverRandom& solverRandom() {
+  return t_solver_random;
+}
+
+void seedSolverRandom(unsigned seed) {
+  t_solver_random.seed(seed);
+}
+
+std::string restartSolver(SolverParam param, Game* game, SolverIterCallback iter_callback, int num_restarts, RestartSolverFunction sub) {
+  if (param.num_restarts > 0) {
+    num_restarts = param.num_restarts;
+  }
+  if (num_restarts == 1 && !param.hasDeadline()) {
+    seedSolverRandom(param.seed);
+    return sub(param, game, iter_callback, 0);
+  }
+
+  std::mutex mutex; // for best_game and iter_callback.
+  std::unique_ptr<Game> best_game;
+  int best_iter = -1;
+  std::atomic<int> best_time(std::numeric_limits<int>::max());
+  auto run = [&](int iter) {
+    SolverParam run_param = param;
+    run_param.seed = param.seed + iter;
+    run_param.num_restarts = 1;
+    run_param.deadline = 0; // checked below.
+    seedSolverRandom(run_param.seed);
+    std::unique_ptr<Game> copied_game(new Game(*game));
+    sub(run_param, copied_game.get(), [&](Game* g) {
+      // runs which can not beat the best are aborted. so are late runs except the first one.
+      if (!g->isEnd() && g->time >= best_time.load()) return false;
+      if (iter > 0 && param.remainingSeconds() <= 0) return false;
+      std::lock_guard<std::mutex> lock(mutex);
+      return !iter_callback || iter_callback(g);
+    }, iter);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!copied_game->isEnd()) return;
+    // ties go to the smaller iter so that the result does not depend on the schedule.
+    if (!best_game || copied_game->time < best_game->time || (copied_game->time == best_game->time && iter < best_iter)) {
+      best_game = std::move(copied_game);
+      best_iter = iter;
+      best_time = best_game->time;
+    }
+  };
+
+  // engines keep per-thread counters, so every run gets a fresh thread.
+  const int num_threads = param.num_threads > 0 ? param.num_threads : std::max<int>(1, std::thread::hardware_concurrency());
+  double round_s = 0;
+  for (int iter = 0;;) {
+    int n = num_threads;
+    if (!param.hasDeadline()) {
+      n = std::min(n, num_restarts - iter);
+    } else if (iter > 0 && param.remainingSeconds() <= round_s) {
+      n = 0;
+    } else if (param.num_restarts > 0) {
+      n = std::min(n, num_restarts - iter);
+    }
+    if (n <= 0) break;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n; ++t, ++iter) {
+      threads.emplace_back(run, iter);
+    }
+    for (auto& t : threads) t.join();
+    round_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  }
+
+  if (best_game) {
+    *game = *best_game;
+  }
+  return game->getCommand();
+}
+
 void ManipulatorExtender::extend() {
   assert (game->num_boosters[BoosterType::MANIPULATOR] > 0);
   if (num_attached_manipulators % 2 == 0) {
@@ -56,44 +170,204 @@ void ManipulatorExtender::extend() {
 }
 
 std::vector<std::vector<Point>> disjointConnectedComponentsByMask(const Map2D& map, int mask, int bits) {
-  constexpr int BACKGROUND = 0;
-  constexpr int FOREGROUND = 1;
-  constexpr int VISITED = 2;
-  Map2D work(map.W, map.H, BACKGROUND);
-  for (int y = 0; y < map.H; ++y) {
-    for (int x = 0; x < map.W; ++x) {
-      if ((map(x, y) & mask) == bits) {
-        work(x, y) = FOREGROUND;
-      }
+  return connectedComponents(BitGrid::fromMask(map, mask, bits));
+}
+
+std::vector<std::vector<Trajectory>> getTrajClones(const Game& game, const std::vector<map_parse::SearchSource>& sources,
+  const std::vector<std::vector<Trajectory>>& plans, int max_dist, bool pairs_first) {
+  // 他のwrapperの計画を見た上で割り振るジョブをキメる
+  std::vector<std::vector<Trajectory>> output(sources.size());
+  // 取得予約済みのアイテムの場所(mapは書き換えずに予約表で除外する)
+  map_parse::ReservationTable reservation(game.map2d);
+  bool spawner = false;
+  int clone_cnt = 0;
+  for (int j = 0; j < plans.size(); ++j) {
+    if (plans[j].empty()) continue;
+    const Point pt = plans[j].back().pos;
+    if (game.map2d(pt) & CellType::kSpawnPointBit) spawner = true;
+    if (game.map2d(pt) & CellType::kBoosterCloningBit) ++clone_cnt;
+    reservation.reserve(pt, j);
+  }
+  if (sources.empty() || clone_cnt == game.booster_index.count(CellType::kBoosterCloningBit)) {
+    return output;
+  }
+  for (auto& w : game.wrappers) {
+    if (game.map2d(w->pos) & CellType::kSpawnPointBit) spawner = true;
+  }
+
+  if (!pairs_first) {
+    // sourcesの順に一つずつ、それまでの割り当てを予約した上で一番近いものを取りに行く
+    const int num_clones = game.booster_index.count(CellType::kBoosterCloningBit);
+    for (int k = 0; k < sources.size() && clone_cnt < num_clones; ++k) {
+      const auto& s = sources[k];
+      // XがなければXに向かう。見つかれば後のwrapperはCを取りに行く
+      const int target_item = (!spawner && game.num_boosters[BoosterType::CLONING] > 0) ?
+        CellType::kSpawnPointBit : CellType::kBoosterCloningBit;
+      output[k] = map_parse::findNearestByBit(game, s.pos, max_dist, target_item, reservation, s.dstart, s.astart);
+      if (output[k].empty()) continue;
+      const Point pt = output[k].back().pos;
+      if (game.map2d(pt) & CellType::kSpawnPointBit) spawner = true;
+      if (game.map2d(pt) & CellType::kBoosterCloningBit) ++clone_cnt;
+      reservation.reserve(pt, s.owner);
     }
+    return output;
   }
 
-  std::vector<std::vector<Point>> components;
-  for (int y = 0; y < work.H; ++y) {
-    for (int x = 0; x < work.W; ++x) {
-      if (work(x, y) == FOREGROUND) {
-        // start BFS fill
-        std::vector<Point> component;
-        std::queue<Point> que;
-        que.push({x, y});
-        work(x, y) = VISITED;
-        component.push_back({x, y});
-        while (!que.empty()) {
-          Point p = que.front(); que.pop();
-          for (auto offset : all_directions) {
-            Point n = p + Point(offset);
-            if (work.isInside(n) && work(n) == FOREGROUND) {
-              que.push(n);
-              work(n) = VISITED;
-              component.push_back(n);
-            }
-          }
+  // 取りに行くアイテム
+  int target_item = CellType::kBoosterCloningBit;
+  int offset = 0;
+  if (!spawner && game.num_boosters[BoosterType::CLONING] > 0) {
+    // Xに向かうのは先頭のwrapperだけ。見つかれば残りはCを取りに行く
+    const auto& s = sources[0];
+    output[0] = map_parse::findNearestByBit(game, s.pos, max_dist, CellType::kSpawnPointBit, reservation, s.dstart, s.astart);
+    if (output[0].empty()) target_item = CellType::kSpawnPointBit;
+    else reservation.reserve(output[0].back().pos, s.owner);
+    offset = 1;
+  }
+
+  // 残りのwrapperは近い組から順に一度に割り当てる
+  const std::vector<map_parse::SearchSource> rest(sources.begin() + offset, sources.end());
+  auto trajs = map_parse::allocateNearestByBit(game, rest, max_dist, target_item, reservation);
+  for (int k = 0; k < trajs.size(); ++k) {
+    output[k + offset] = std::move(trajs[k]);
+  }
+  return output;
+}
+
+SweepPlan findOrientationAwareSweep(const Map2D& map, Point start, Direction start_dir,
+  const std::vector<Point>& manipulators, int max_steps, int beam_width) {
+  static constexpr int kUnwrappedMask = CellType::kObstacleBit | CellType::kWrappedBit;
+  assert (map.isInside(start));
+
+  // manipulator offsets for each direction. (same rotation as Wrapper::turn)
+  std::array<std::vector<Point>, 4> offsets;
+  {
+    Direction dir = start_dir;
+    std::vector<Point> manip = manipulators;
+    for (int i = 0; i < 4; ++i) {
+      offsets[int(dir)] = manip;
+      for (auto& m : manip) m = Point(m.y, -m.x);
+      dir = turnCW(dir);
+    }
+  }
+
+  // lattice states are limited to the window reachable within max_steps.
+  const int x0 = std::max(0, start.x - max_steps);
+  const int x1 = std::min(map.W, start.x + max_steps + 1);
+  const int y0 = std::max(0, start.y - max_steps);
+  const int y1 = std::min(map.H, start.y + max_steps + 1);
+  auto latticeIndex = [&](Point p, Direction d) {
+    return ((p.y - y0) * (x1 - x0) + (p.x - x0)) * 4 + int(d);
+  };
+  const int num_states = (x1 - x0) * (y1 - y0) * 4;
+  std::vector<std::vector<int>> footprints(num_states);
+  std::vector<bool> footprint_ready(num_states, false);
+  // unwrapped cells covered at the state. (linear index)
+  auto footprint = [&](Point p, Direction d) -> const std::vector<int>& {
+    const int s = latticeIndex(p, d);
+    if (!footprint_ready[s]) {
+      footprint_ready[s] = true;
+      if ((map(p) & kUnwrappedMask) == 0) {
+        footprints[s].push_back(p.y * map.W + p.x);
+      }
+      for (auto m : absolutePositionOfReachableManipulators(map, p, offsets[int(d)])) {
+        if ((map(m) & kUnwrappedMask) == 0) {
+          footprints[s].push_back(m.y * map.W + m.x);
         }
-        components.push_back(component);
       }
     }
+    return footprints[s];
+  };
+
+  // cells covered along the path to a node are marked with the node index before its children are expanded.
+  // (parent-chain walk + stamp. no clearing, and no copy of the path per node)
+  int reach = 0;
+  for (auto& m : manipulators) reach = std::max(reach, std::max(std::abs(m.x), std::abs(m.y)));
+  const int cx0 = std::max(0, x0 - reach);
+  const int cx1 = std::min(map.W, x1 + reach);
+  const int cy0 = std::max(0, y0 - reach);
+  const int cy1 = std::min(map.H, y1 + reach);
+  std::vector<int> covered_stamp((cx1 - cx0) * (cy1 - cy0), -1);
+  auto coveredIndex = [&](int c) {
+    return (c / map.W - cy0) * (cx1 - cx0) + (c % map.W - cx0);
+  };
+
+  struct Node {
+    Point pos;
+    Direction dir;
+    int gain;
+    int parent;
+    char command;
+    std::vector<int> newly; // cells wrapped first at this node.
+  };
+  std::vector<Node> nodes;
+  nodes.push_back({start, start_dir, 0, -1, 0, {}});
+  std::vector<int> layer = {0};
+  int best = 0;
+
+  const std::array<Direction, 4> moves = {Direction::W, Direction::A, Direction::S, Direction::D};
+  for (int step = 0; step < max_steps && !layer.empty(); ++step) {
+    std::unordered_map<int, int> lattice_to_node; // dedup by (cell, direction).
+    std::vector<int> next_layer;
+    auto expand = [&](int parent, Point pos, Direction dir, char command) {
+      const auto& fp = footprint(pos, dir);
+      std::vector<int> newly;
+      for (int c : fp) {
+        if (covered_stamp[coveredIndex(c)] != parent) {
+          newly.push_back(c);
+        }
+      }
+      const int gain = nodes[parent].gain + newly.size();
+      const int s = latticeIndex(pos, dir);
+      auto it = lattice_to_node.find(s);
+      if (it != lattice_to_node.end() && nodes[it->second].gain >= gain) return;
+
+      Node node {pos, dir, gain, parent, command, std::move(newly)};
+      if (it != lattice_to_node.end()) {
+        nodes[it->second] = std::move(node);
+      } else {
+        lattice_to_node[s] = nodes.size();
+        next_layer.push_back(nodes.size());
+        nodes.push_back(std::move(node));
+      }
+    };
+
+    for (int i : layer) {
+      for (int n = i; n >= 0; n = nodes[n].parent) {
+        for (int c : nodes[n].newly) covered_stamp[coveredIndex(c)] = i;
+      }
+      const Point pos = nodes[i].pos;
+      const Direction dir = nodes[i].dir;
+      for (auto move : moves) {
+        const Point n = pos + Point(move);
+        if (n.x < x0 || x1 <= n.x || n.y < y0 || y1 <= n.y) continue;
+        if (map(n) & CellType::kObstacleBit) continue;
+        expand(i, n, dir, Direction2Char(move));
+      }
+      expand(i, pos, turnCW(dir), Action::CW);
+      expand(i, pos, turnCCW(dir), Action::CCW);
+    }
+
+    std::stable_sort(next_layer.begin(), next_layer.end(), [&](int lhs, int rhs) {
+      return nodes[lhs].gain > nodes[rhs].gain;
+    });
+    if (next_layer.size() > beam_width) {
+      next_layer.resize(beam_width);
+    }
+    for (int i : next_layer) {
+      // prefer shorter plans for the same gain.
+      if (nodes[best].gain < nodes[i].gain) best = i;
+    }
+    layer.swap(next_layer);
   }
-  return components;
+
+  SweepPlan plan;
+  plan.gain = nodes[best].gain;
+  for (int i = best; nodes[i].parent >= 0; i = nodes[i].parent) {
+    plan.commands.push_back(nodes[i].command);
+  }
+  std::reverse(plan.commands.begin(), plan.commands.end());
+  return plan;
 }
 
 std::unique_ptr<FindFCRouteResult> findGoodFCRoute(const Map2D& map, Point start) {
@@ -251,9 +525,14 @@ bool ConnectedComponentAssignmentForParanoid::update() {
   // hungarian method
   const int sz = std::max(N, M);
   detail::matrix preference(sz, std::vector<int>(sz, 0)); // preference[wrapper][component]
-  // to avoid occilation, it is suggested to use the motion found in the shortestPathByMaskBFS.
+  // to avoid occilation, it is suggested to use the first motion of the shortest path.
   std::vector<std::vector<Point>> suggested_motion(sz, std::vector<Point>(sz, {0, 0}));
-  std::vector<std::vector<Point>> target(sz, std::vector<Point>(sz, {-1, -1}));
+  BitGridBFS bfs(BitGrid::fromMask(game->map2d, CellType::kObstacleBit, 0)); // inside room
+  std::vector<BitGrid> component_bits;
+  for (auto& component : components) {
+    component_bits.emplace_back(game->map2d.W, game->map2d.H);
+    for (auto p : component.points) component_bits.back().set(p);
+  }
   for (int i = 0; i < sz; ++i) {
     for (int j = 0; j < sz; ++j) {
       if (i < N && j < M) {
@@ -278,21 +557,19 @@ bool ConnectedComponentAssignmentForParanoid::update() {
           nearest_manhattan = std::min(nearest_manhattan, (pos - p).lengthManhattan());
         }
         if (nearest_manhattan < distance_threshold) {
-          Map2D map(game->map2d.W, game->map2d.H, 0);
-          std::vector<Point> path = shortestPathByMaskBFS(game->map2d,
-            CellType::kObstacleBit, 0, // inside room
-            //pos, findNearestPoints(components[j].points, components[j].center)); // (1)
-            pos, components[j].points);
-          if (path.size() < distance_threshold) {
-            preference[i][j] = distance_threshold - path.size();
+          // # of cells on the path. (0 if unreachable, as the former shortestPathByMaskBFS)
+          // (1): targets = findNearestPoints(components[j].points, components[j].center)
+          const int distance = bfs.run(pos, component_bits[j]);
+          const int path_size = distance < 0 ? 0 : distance + 1;
+          if (path_size < distance_threshold) {
+            preference[i][j] = distance_threshold - path_size;
             if (true) {
               // add small-region bonus.
               // components are sorted. (j==0: smallest, j==M-1: largest.)
               preference[i][j] += small_region_bonus * (M - j); // large preference for small j.
             }
-            if (path.size() >= 2) {
-              suggested_motion[i][j] = path[1] - path[0];
-              target[i][j] = path.back();
+            if (path_size >= 2) {
+              suggested_motion[i][j] = bfs.firstStep();
             }
           }
         }
@@ -306,7 +583,6 @@ bool ConnectedComponentAssignmentForParanoid::update() {
     const int j = wrapper_to_component[i];
     if (j != UNASSIGNED && j < M) {
       components[j].suggested_motion = suggested_motion[i][j];
-      components[j].target = target[i][j];
     }
   }
 
@@ -2,8 +2,10 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include "wrapper.h"
 #include "game.h"
+#include "map_parse.h"
 #include "solver_registry.h"
 
 // override this.
@@ -26,6 +28,37 @@ protected:
 std::string wrapperEngineSolver(SolverParam param, Game* game, SolverIterCallback iter_callback, WrapperEngineBase::Ptr prototype);
 std::string functorSolver(SolverParam param, Game* game, SolverIterCallback iter_callback, std::function<Wrapper*(Wrapper*)> func);
 
+// the same sequence as rand() of glibc after srand(seed), but with its own state.
+// (additive feedback generator x[i] = x[i-3] + x[i-31])
+class SolverRandom {
+public:
+  using result_type = std::uint32_t;
+  explicit SolverRandom(unsigned seed = 1) { this->seed(seed); }
+  void seed(unsigned seed);
+  result_type operator()();
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return 0x7fffffff; }
+
+private:
+  std::int32_t state[31];
+  int front = 3;
+  int rear = 0;
+};
+
+// per-thread random number generator for engines. (use this instead of rand())
+// restartSolver() seeds it for each run.
+SolverRandom& solverRandom();
+void seedSolverRandom(unsigned seed);
+
+// multi-restart driver. run sub on copies of game concurrently and keep the best complete one in game.
+// the run `iter` uses the seed param.seed + iter. param.num_restarts overrides num_restarts.
+// without a deadline, it runs num_restarts times. with a deadline, it keeps running restarts while
+// another round fits in the remaining time. (up to param.num_restarts if it is given)
+// runs which can not beat the best so far are aborted through the iteration callback, and so are
+// runs over the deadline except the first one, so that there is always a complete answer.
+using RestartSolverFunction = std::function<std::string(SolverParam, Game*, SolverIterCallback, int /* iter */)>;
+std::string restartSolver(SolverParam param, Game* game, SolverIterCallback iter_callback, int num_restarts, RestartSolverFunction sub);
+
 struct ManipulatorExtender {
   //   :
   //   2
@@ -47,8 +80,30 @@ private:
   int num_attached_manipulators = 0;
 };
 
+// 4-connected components of cells with (map(x, y) & mask) == bits, in the raster order of their first cells.
+// points of each component are also in the raster order.
 std::vector<std::vector<Point>> disjointConnectedComponentsByMask(const Map2D& map, int mask, int bits);
 
+// trajectories of wrappers (multispawn, multispawn2, distspawn) to distinct C which are not the goals of |plans|.
+// (plans[j]: the current trajectory of wrapper j) if C is in hand and no wrapper is on or heading to X,
+// sources[0] goes to the nearest X, and the rest go to C. sources are assigned one by one in order,
+// or by allocateNearestByBit() if |pairs_first|. (--allocate-pairs-first)
+// result[k] is for sources[k], and empty if nothing is left. the map is not touched.
+std::vector<std::vector<Trajectory>> getTrajClones(const Game& game, const std::vector<map_parse::SearchSource>& sources,
+  const std::vector<std::vector<Trajectory>>& plans, int max_dist, bool pairs_first = false);
+
+// bounded search over (cell, direction) lattice states of a wrapper.
+// edges are moves (WASD) and turns (EQ) of unit time cost, and the weight of an edge is
+// the number of unwrapped cells newly covered by the footprint (body + reachable manipulators)
+// of the destination state. it is cheaper than trying turns by simulate/undo on Game.
+// NOTE: boosters (F, L) are not considered. re-plan after executing the first command.
+struct SweepPlan {
+  std::string commands; // W/A/S/D/E/Q. empty if no unwrapped cell is reachable within max_steps.
+  int gain = 0; // # of newly wrapped cells by commands.
+};
+SweepPlan findOrientationAwareSweep(const Map2D& map, Point start, Direction start_dir,
+  const std::vector<Point>& manipulators, int max_steps, int beam_width = 64);
+
 // since it is crutial to reach to C as soon as possible,
 // consider whether picking and using of F might be useful.
 // start -> F(use immediately) -> C
@@ -91,7 +146,6 @@ private:
     std::vector<Point> points;
     Point center; // approx. centroid of points.
     Point suggested_motion; // one of neighbor-4
-    Point target;
   };
 
   Game* game = nullptr;
@@ -1,9 +1,16 @@
 #include "solver_registry.h"
 #include <iostream>
 #include <chrono>
+#include <limits>
 #include <thread>
 #include <experimental/filesystem>
 
+double SolverParam::remainingSeconds() const {
+  if (!hasDeadline()) return std::numeric_limits<double>::infinity();
+  const double now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+  return deadline - now;
+}
+
 void displayAndWait(SolverParam param, Game* game) {
   if (param.wait_ms > 0) {
     std::cout << "\033[2J\033[1;1H"; // clear screen and return to top-left.
@@ -8,9 +8,23 @@
 
 struct SolverParam {
   int wait_ms = 0;
+  // wall clock budget. main() turns --time-limit into deadline.
+  double time_limit_s = 0; // 0: no limit.
+  double deadline = 0;     // seconds since the epoch. 0: no deadline.
+  // restarts. (see restartSolver())
+  int num_restarts = 0;    // 0: engine default.
+  int num_threads = 0;     // 0: all cores.
+  unsigned seed = 3333;
+  // clone targets of multispawn, multispawn2 and distspawn. (see getTrajClones())
+  bool allocate_pairs_first = false;
+
+  bool hasDeadline() const { return deadline > 0; }
+  // seconds until the deadline. +inf if no deadline.
+  double remainingSeconds() const;
 };
 struct PuzzleSolverParam {
   int wait_ms = 0;
+  unsigned seed = 88675123; // each solver call owns its RNG seeded with this.
 };
 
 void displayAndWait(SolverParam param, Game* game);
@@ -23,6 +37,9 @@ using PuzzleSolverFunction = std::function<PuzzleSolution(PuzzleSolverParam, Puz
 #define CONCAT(a, b) CONCAT_SUB(a, b)
 #define REGISTER_SOLVER(name, func) \
   static SolverRegistry<SolverFunction> CONCAT(_register_solver_, __LINE__) = {name, {__FILE__, func}}
+// for engines which move only game->wrappers[0]. they can not continue a game with clones.
+#define REGISTER_SINGLE_WRAPPER_SOLVER(name, func) \
+  static SolverRegistry<SolverFunction> CONCAT(_register_solver_, __LINE__) = {name, {__FILE__, func, true}}
 #define REGISTER_PUZZLE_SOLVER(name, func) \
   static SolverRegistry<PuzzleSolverFunction> CONCAT(_register_solver_, __LINE__) = {name, {__FILE__, func}}
 
@@ -31,6 +48,7 @@ struct SolverRegistry {
   struct SolverEntry {
     std::string file_name;
     Func function;
+    bool single_wrapper = false; // REGISTER_SINGLE_WRAPPER_SOLVER
   };
   static std::map<std::string, SolverEntry>& getRegistry() {
     static std::map<std::string, SolverEntry> s_solver_registry;
@@ -1,6 +1,6 @@
 #include "game.h"
+#include "bit_grid.h"
 
-#include <queue>
 #include <iostream>
 
 using namespace std;
@@ -8,28 +8,7 @@ using namespace std;
 namespace utils {
   int countUnWrappedArea(const Game &game, const Point &from) {
     static const int kMask = CellType::kObstacleBit | CellType::kWrappedBit;
-    const int H = game.map2d.H;
-    const int W = game.map2d.W;
-    int count(0);
-    queue<Point> que;
-    que.push(from);
-    Point d[4] = {Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0)};
-    auto &map2d(game.map2d);
-    vector<vector<bool>> visited(H, vector<bool>(W, false));
-
-    while (!que.empty()) {
-      auto p = que.front();
-      que.pop();
-      cout << p << endl;
-      if (map2d.isInside(p) && (map2d(p) & kMask) == 0 && !visited[p.y][p.x]) {
-        ++count;
-        visited[p.y][p.x] = true;
-        for (int i = 0; i < 4; ++i) {
-          que.push(p+d[i]);
-        }
-      }
-    }
-    return count;
+    return floodFill(BitGrid::fromMask(game.map2d, kMask, 0), from).count();
   }
 
   vector<vector<double>> getGloryMap(const Game &game) {
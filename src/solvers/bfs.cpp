@@ -22,4 +22,4 @@ std::string bfsSolver(SolverParam param, Game* game, SolverIterCallback iter_cal
   return game->getCommand();
 }
 
-REGISTER_SOLVER("bfs", bfsSolver);
+REGISTER_SINGLE_WRAPPER_SOLVER("bfs", bfsSolver);
@@ -25,4 +25,4 @@ std::string bfs2Solver(SolverParam param, Game* game, SolverIterCallback iter_ca
   return game->getCommand();
 }
 
-REGISTER_SOLVER("bfs2", bfs2Solver);
+REGISTER_SINGLE_WRAPPER_SOLVER("bfs2", bfs2Solver);
@@ -5,7 +5,8 @@
 #include "solver_registry.h"
 
 std::string bfs3Solver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
-  int num_add_manipulators = 0;
+  // manipulators which are already attached. (e.g. continuing a game of another engine)
+  int num_add_manipulators = game->wrappers[0]->numAddedManipulators();
   while (true) {
     Wrapper* w = game->wrappers[0].get();
     if (game->num_boosters[BoosterType::MANIPULATOR] > 0) {
@@ -37,4 +38,4 @@ std::string bfs3Solver(SolverParam param, Game* game, SolverIterCallback iter_ca
   return game->getCommand();
 }
 
-REGISTER_SOLVER("bfs3", bfs3Solver);
+REGISTER_SINGLE_WRAPPER_SOLVER("bfs3", bfs3Solver);
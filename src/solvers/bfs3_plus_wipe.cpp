@@ -92,4 +92,4 @@ std::string bfs3_plus_wipe_Solver(SolverParam param, Game* game, SolverIterCallb
   return game->getCommand();
 }
 
-REGISTER_SOLVER("bfs3_plus_wipe", bfs3_plus_wipe_Solver);
+REGISTER_SINGLE_WRAPPER_SOLVER("bfs3_plus_wipe", bfs3_plus_wipe_Solver);
@@ -33,4 +33,4 @@ std::string bfs4Solver(SolverParam param, Game* game, SolverIterCallback iter_ca
   return game->getCommand();
 }
 
-REGISTER_SOLVER("bfs4", bfs4Solver);
+REGISTER_SINGLE_WRAPPER_SOLVER("bfs4", bfs4Solver);
@@ -8,7 +8,7 @@ using namespace std;
 
 namespace {
 struct WrapperEngine {
-  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(0) { m_total_wrappers++; };
+  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(game->wrappers[id]->numAddedManipulators()) { m_total_wrappers++; };
   Wrapper *action() {
     if (m_game->num_boosters[BoosterType::MANIPULATOR] > 0 && (m_game->num_boosters[BoosterType::MANIPULATOR] + m_total_manipulators > m_total_wrappers * m_num_manipulators)) {
       if (m_num_manipulators % 2 == 0) {
@@ -39,18 +39,20 @@ struct WrapperEngine {
   int m_id;
   Wrapper *m_wrapper;
   int m_num_manipulators;
-  static int m_total_manipulators;
-  static int m_total_wrappers;
+  static thread_local int m_total_manipulators;
+  static thread_local int m_total_wrappers;
 };
 
-int WrapperEngine::m_total_manipulators = 0;
-int WrapperEngine::m_total_wrappers = 0;
+thread_local int WrapperEngine::m_total_manipulators = 0;
+thread_local int WrapperEngine::m_total_wrappers = 0;
 };
 
 std::string bfs5_4Solver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
-  int num_wrappers = 1;
+  int num_wrappers = game->wrappers.size();
   vector<WrapperEngine> ws;
-  ws.emplace_back(WrapperEngine(game, 0));
+  for (int i = 0; i < game->wrappers.size(); ++i) {
+    ws.emplace_back(WrapperEngine(game, i));
+  }
   int epoch(0);
   while (!game->isEnd()) {
 //    cout << epoch << ": ";
@@ -8,7 +8,7 @@ using namespace std;
 
 namespace {
 struct WrapperEngine {
-  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(0) {};
+  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(game->wrappers[id]->numAddedManipulators()) {};
   Wrapper *action() {
     if (((m_game->map2d(m_wrapper->pos) & CellType::kSpawnPointBit) != 0) && m_game->num_boosters[BoosterType::CLONING]) {
 //      cout << m_id << ": clone: " << m_wrapper->pos << endl;
@@ -33,9 +33,11 @@ struct WrapperEngine {
 };
 
 std::string bfs5_5Solver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
-  int num_wrappers = 1;
+  int num_wrappers = game->wrappers.size();
   vector<WrapperEngine> ws;
-  ws.emplace_back(WrapperEngine(game, 0));
+  for (int i = 0; i < game->wrappers.size(); ++i) {
+    ws.emplace_back(WrapperEngine(game, i));
+  }
   int epoch(0);
   while (!game->isEnd()) {
 //    cout << epoch << ": ";
@@ -7,7 +7,7 @@
 using namespace std;
 
 struct WrapperEngine {
-  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), w(game->wrappers[id].get()), m_num_manipulators(0) {};
+  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), w(game->wrappers[id].get()), m_num_manipulators(game->wrappers[id]->numAddedManipulators()) {};
   Wrapper *action() {
     if (m_game->num_boosters[BoosterType::MANIPULATOR] > 0) {
       if (m_num_manipulators % 2 == 0) {
@@ -78,9 +78,11 @@ struct WrapperEngine {
 };
 
 std::string bfs5_plus_wipe_Solver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
-  int num_wrappers = 1;
+  int num_wrappers = game->wrappers.size();
   vector<WrapperEngine> ws;
-  ws.emplace_back(WrapperEngine(game, 0));
+  for (int i = 0; i < game->wrappers.size(); ++i) {
+    ws.emplace_back(WrapperEngine(game, i));
+  }
   int epoch(0);
   while (!game->isEnd()) {
 //    cout << epoch << ": ";
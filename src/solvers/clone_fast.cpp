@@ -11,7 +11,7 @@ using namespace std;
 
 namespace {
 struct WrapperEngine {
-  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(0) { m_total_wrappers++; };
+  WrapperEngine(Game *game, int id) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(game->wrappers[id]->numAddedManipulators()) { m_total_wrappers++; };
   Wrapper *action(double x, double y, std::vector<Trajectory> &to_go) {
     //cout<<to_go.size()<<","<<(m_wrapper->pos.x)<<","<<(m_wrapper->pos.y)<<std::endl;
     if (m_game->num_boosters[BoosterType::MANIPULATOR] > 0 && (m_game->num_boosters[BoosterType::MANIPULATOR] + m_total_manipulators > m_total_wrappers * m_num_manipulators)) {
@@ -132,12 +132,12 @@ struct WrapperEngine {
   int m_id;
   Wrapper *m_wrapper;
   int m_num_manipulators;
-  static int m_total_manipulators;
-  static int m_total_wrappers;
+  static thread_local int m_total_manipulators;
+  static thread_local int m_total_wrappers;
 };
 
-int WrapperEngine::m_total_manipulators = 0;
-int WrapperEngine::m_total_wrappers = 0;
+thread_local int WrapperEngine::m_total_manipulators = 0;
+thread_local int WrapperEngine::m_total_wrappers = 0;
 };
 
 static std::vector<std::vector<Trajectory>> getItemMatrixfast(Game* game, const int mask){
@@ -153,12 +153,14 @@ static std::vector<std::vector<Trajectory>> getItemMatrixfast(Game* game, const
 }
 
 std::string clonefastSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
-  int num_wrappers = 1;
+  int num_wrappers = game->wrappers.size();
   vector<WrapperEngine> ws;
   bool clone_mode = false;
-  ws.emplace_back(WrapperEngine(game, 0));
+  for (int i = 0; i < game->wrappers.size(); ++i) {
+    ws.emplace_back(WrapperEngine(game, i));
+  }
   int epoch(0);
-  bool clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+  bool clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
   std::vector<std::vector<Trajectory>> cmat;
   cmat = std::vector<std::vector<Trajectory>>(game->wrappers.size());
   
@@ -168,7 +170,7 @@ std::string clonefastSolver(SolverParam param, Game* game, SolverIterCallback it
   while (!game->isEnd()) {
 //    cout << epoch << ": ";
     //cout<<*game<<endl;
-    clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+    clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
 
     if(cmat.size() < game->wrappers.size()){
       cmat.resize(game->wrappers.size());
@@ -7,9 +7,9 @@
 #include "solver_helper.h"
 
 std::string mcSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
-  std::vector<Point> Bs = enumerateCellsByMask(game->map2d, CellType::kBoosterManipulatorBit, CellType::kBoosterManipulatorBit);
-  std::vector<Point> Cs = enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit);
-  std::vector<Point> Xs = enumerateCellsByMask(game->map2d, CellType::kSpawnPointBit, CellType::kSpawnPointBit);
+  std::vector<Point> Bs = game->booster_index.positions(CellType::kBoosterManipulatorBit);
+  std::vector<Point> Cs = game->booster_index.positions(CellType::kBoosterCloningBit);
+  std::vector<Point> Xs = game->booster_index.positions(CellType::kSpawnPointBit);
   std::cout << "B: " << Bs.size() << ", C: " << Cs.size() << ", X: " << Xs.size() << std::endl;
 
   std::map<Wrapper*, ManipulatorExtender*> manipulator_extender; // とりあえずリークは無視
@@ -69,39 +69,24 @@ std::string mcSolver(SolverParam param, Game* game, SolverIterCallback iter_call
     }
 
     // B, C, X を終えたので好きに動く
-    const std::vector<Trajectory> trajs = map_parse::findNearestUnwrapped(*game, w->pos, DISTANCE_INF);
+    // 回転も含めて k step の間に塗れる数が最大になる経路を探し、その最初の1手だけ実行する
+    const int k = 8;
+    const SweepPlan plan = findOrientationAwareSweep(game->map2d, w->pos, w->direction, w->manipulators, k);
+    if (plan.gain > 0) {
+      const char c = plan.commands[0];
+      if (c == Action::CW || c == Action::CCW) {
+        w->turn(c);
+      } else {
+        w->move(c);
+      }
+      return nullptr;
+    }
 
+    // 近くに塗れる場所がないので最寄りの未塗装セルへ向かう
+    const std::vector<Trajectory> trajs = map_parse::findNearestUnwrapped(*game, w->pos, DISTANCE_INF);
     if (trajs.size() > 0) {
-      // k stepの間に塗れる数が増えるならturnする
-      const int k = 8;
-      int painted[4] = {0};
-      int best_iturn = 0;
-      for (int iturn = 0; iturn < 4; ++iturn) {
-        int n_undo = 0;
-        // iturn回の回転
-        for (; n_undo < iturn; ++n_undo) {
-          w->turn(Action::CCW);
-          painted[iturn] += w->getLastNumWrapped();
-        }
-        // 残りを移動に使う
-        for (; n_undo < std::min<int>(k, trajs.size()); ++n_undo) {
-          const char c = Direction2Char(trajs[n_undo].last_move);
-          w->move(c);
-          painted[iturn] += w->getLastNumWrapped();
-        }
-        while (n_undo--) {
-          w->undoAction();
-        }
-        if (painted[best_iturn] < painted[iturn]) {
-          best_iturn = iturn;
-        }
-      }
-      // 最も良いものを選ぶ
-      // iturn回の回転
-      for (int i = 0; i < best_iturn; ++i) {
-        w->turn(Action::CCW);
-        game->tick();
-      }
+      w->move(Direction2Char(trajs[0].last_move));
+      return nullptr;
     }
 
     w->nop();
@@ -109,5 +94,5 @@ std::string mcSolver(SolverParam param, Game* game, SolverIterCallback iter_call
   });
 }
 
-REGISTER_SOLVER("mc", mcSolver);
+REGISTER_SINGLE_WRAPPER_SOLVER("mc", mcSolver);
 
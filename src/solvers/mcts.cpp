@@ -0,0 +1,356 @@
+// mcts.cpp : Monte Carlo tree search over macro-actions of wrappers.
+// a decision gives a goal (sweep, fetch B, fetch C and clone, go to a disjoint region) to one wrapper,
+// in turn, and the goals are followed for kSegmentTicks. leaves are evaluated by running greedy engines
+// (default policies) to the end of the game. every thread grows its own tree from the same root (root parallel),
+// and the most visited goal over all trees is played.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+
+#include "map_parse.h"
+#include "solver_registry.h"
+#include "solver_helper.h"
+#include "transposition_table.h"
+
+namespace {
+
+constexpr int kSegmentTicks = 10;
+constexpr int kNumRegions = 3;
+// iterations per thread and decision without a deadline.
+constexpr int kIterationsWithoutDeadline = 16;
+// with a deadline, the search stops when this fraction of the time is left, and the default policy finishes the game.
+constexpr double kFinishReserve = 0.25;
+constexpr double kExploration = 0.7;
+// bfs2 moves only the first wrapper, so it is used only while there is one wrapper.
+const std::vector<std::string> kDefaultPolicies = {"bfs5_6", "bfs2"};
+
+enum GoalType { kSweep, kFetchManipulator, kFetchCloning, kRegion };
+struct Goal {
+  GoalType type = kSweep;
+  Point target; // kRegion
+};
+
+// wrappers never turn here, since the default policies attach manipulators in the initial frame.
+// manipulators go to the same slots as bfs5_6, so that it can continue to extend the arms.
+bool attachManipulator(Wrapper* w) {
+  for (int k = 0; k < 32; ++k) {
+    const Point p = k % 2 == 0 ? Point(0, 1 + k / 2) : Point(0, -1 - k / 2);
+    if (w->canAddManipulator(p)) return w->addManipulator(p);
+  }
+  return false;
+}
+
+bool moveAlong(Wrapper* w, const std::vector<Trajectory>& trajs) {
+  if (trajs.empty()) return false;
+  w->move(Direction2Char(trajs[0].last_move));
+  return true;
+}
+
+// one step of bfs5_6: to the unwrapped neighbor towards the centroid of the wrappers, or to the nearest unwrapped cell.
+void sweep(Game* game, Wrapper* w) {
+  static const int kMask = CellType::kObstacleBit | CellType::kWrappedBit;
+  double x = 0, y = 0;
+  for (auto& v : game->wrappers) {
+    x += v->pos.x;
+    y += v->pos.y;
+  }
+  x = x / game->wrappers.size() - w->pos.x;
+  y = y / game->wrappers.size() - w->pos.y;
+  // the primary axis first, then the other one.
+  const Point dx(x > 0 ? 1 : -1, 0), dy(0, y > 0 ? 1 : -1);
+  std::vector<Point> order;
+  if (std::abs(x) > std::abs(y)) {
+    order = {dx};
+    if (y != 0) order.push_back(dy);
+  } else if (y != 0) {
+    order = {dy};
+    if (x != 0) order.push_back(dx);
+  }
+  for (auto& d : order) {
+    if (game->map2d.isInside(w->pos + d) && (game->map2d(w->pos + d) & kMask) == 0) {
+      w->move(d == Point(1, 0) ? Action::RIGHT : d == Point(-1, 0) ? Action::LEFT : d == Point(0, 1) ? Action::UP : Action::DOWN);
+      return;
+    }
+  }
+  if (!moveAlong(w, map_parse::findNearestUnwrapped(*game, w->pos, DISTANCE_INF))) w->nop();
+}
+
+// goals of the wrappers. (index: Wrapper::index) a goal falls back to kSweep when it is done or impossible.
+struct MacroPolicy {
+  std::vector<Goal> goals;
+
+  Goal& goalOf(int index) {
+    if (index >= goals.size()) goals.resize(index + 1);
+    return goals[index];
+  }
+
+  void step(Game* game, Wrapper* w) {
+    Goal& goal = goalOf(w->index);
+    switch (goal.type) {
+    case kFetchManipulator:
+      // a booster under the wrapper is picked before the action.
+      if ((game->num_boosters[BoosterType::MANIPULATOR] > 0 || (game->map2d(w->pos) & CellType::kBoosterManipulatorBit)) && attachManipulator(w)) {
+        goal = Goal();
+        return;
+      }
+      if (moveAlong(w, map_parse::findNearestByBit(*game, w->pos, DISTANCE_INF, CellType::kBoosterManipulatorBit))) return;
+      goal = Goal();
+      break;
+    case kFetchCloning:
+      if (game->num_boosters[BoosterType::CLONING] > 0) {
+        if (game->map2d(w->pos) & CellType::kSpawnPointBit) {
+          w->cloneWrapper();
+          goal = Goal();
+          return;
+        }
+        if (moveAlong(w, map_parse::findNearestByBit(*game, w->pos, DISTANCE_INF, CellType::kSpawnPointBit))) return;
+      } else if (moveAlong(w, map_parse::findNearestByBit(*game, w->pos, DISTANCE_INF, CellType::kBoosterCloningBit))) {
+        return;
+      }
+      goal = Goal();
+      break;
+    case kRegion:
+      if (w->pos != goal.target && (game->map2d(goal.target) & CellType::kWrappedBit) == 0 &&
+          moveAlong(w, map_parse::findTrajectory(*game, w->pos, goal.target, DISTANCE_INF))) {
+        return;
+      }
+      goal = Goal();
+      break;
+    case kSweep:
+      break;
+    }
+    sweep(game, w);
+  }
+
+  // false if the callback stops the game.
+  bool run(SolverParam param, Game* game, int ticks, SolverIterCallback callback) {
+    for (int t = 0; t < ticks && !game->isEnd(); ++t) {
+      for (auto& w : game->wrappers) step(game, w.get());
+      game->tick();
+      displayAndWait(param, game);
+      if (callback && !callback(game)) return false;
+    }
+    return true;
+  }
+};
+
+// goals which the wrapper can take now. kSweep is always the first.
+// an unfinished goal is kept, or the wrapper can go back and forth between two goals forever.
+std::vector<Goal> candidateGoals(const Game& game, const Wrapper& w, const Goal& current) {
+  if (current.type != kSweep) return {current};
+  std::vector<Goal> goals = {Goal()};
+  const auto& index = game.booster_index;
+  if (game.num_boosters[BoosterType::MANIPULATOR] > 0 || !index.positions(CellType::kBoosterManipulatorBit).empty()) {
+    goals.push_back({kFetchManipulator, Point()});
+  }
+  if ((game.num_boosters[BoosterType::CLONING] > 0 || !index.positions(CellType::kBoosterCloningBit).empty()) &&
+      !index.positions(CellType::kSpawnPointBit).empty()) {
+    goals.push_back({kFetchCloning, Point()});
+  }
+  // the nearest cells of the largest unwrapped regions, if the unwrapped cells are split.
+  auto regions = disjointConnectedComponentsByMask(game.map2d, CellType::kObstacleBit | CellType::kWrappedBit, 0);
+  if (regions.size() >= 2) {
+    std::stable_sort(regions.begin(), regions.end(), [](const std::vector<Point>& a, const std::vector<Point>& b) {
+      return a.size() > b.size();
+    });
+    for (int r = 0; r < std::min<int>(kNumRegions, regions.size()); ++r) {
+      const Point target = *std::min_element(regions[r].begin(), regions[r].end(), [&](Point a, Point b) {
+        return std::abs(a.x - w.pos.x) + std::abs(a.y - w.pos.y) < std::abs(b.x - w.pos.x) + std::abs(b.y - w.pos.y);
+      });
+      goals.push_back({kRegion, target});
+    }
+  }
+  return goals;
+}
+
+// runs a greedy engine for `ticks` ticks (0: to the end) on a fresh thread, since engines keep per-thread counters.
+void runDefaultPolicy(const std::string& engine, SolverParam param, Game* game, int ticks, SolverIterCallback callback) {
+  SolverFunction solver = SolverRegistry<SolverFunction>::getSolver(engine);
+  std::thread([&]() {
+    int i = 0;
+    solver(param, game, [&](Game* g) {
+      if (callback && !callback(g)) return false;
+      return ticks <= 0 || ++i < ticks;
+    });
+  }).join();
+}
+
+struct Node {
+  Goal goal;
+  int first_child = -1;
+  int num_children = 0;
+  bool duplicate = false; // leads to a state which another node has reached. never selected.
+  int visits = 0;
+  double total = 0; // sum of rewards.
+};
+
+// a tree grown by one thread. node 0 is the root.
+class SearchTree {
+public:
+  SearchTree(const Game& root_, const MacroPolicy& root_policy_, int decision_, unsigned seed)
+    : root(root_), root_policy(root_policy_), decision(decision_), rng(seed), nodes(1) {
+  }
+
+  void iterate() {
+    Game game(root);
+    MacroPolicy policy(root_policy);
+    std::vector<int> path = {0};
+    int node = 0;
+    int depth = 0;
+    while (!game.isEnd()) {
+      if (nodes[node].first_child < 0) {
+        if (node != 0 && nodes[node].visits == 0) break; // evaluate a new leaf first.
+        expand(node, game, policy, decision + depth);
+      }
+      const int child = select(node);
+      if (child < 0) break; // no child, or all of them are duplicates.
+      policy.goalOf(decidingWrapper(game, decision + depth)) = nodes[child].goal;
+      policy.run(SolverParam(), &game, kSegmentTicks, nullptr);
+      ++depth;
+      node = child;
+      path.push_back(node);
+      if (nodes[node].visits == 0) {
+        if (!visited.visit(game.hash(), game.time)) {
+          nodes[node].duplicate = true;
+          return;
+        }
+        break;
+      }
+    }
+
+    if (!game.isEnd()) {
+      const int num_policies = game.nextWrapperIndex() == 1 ? kDefaultPolicies.size() : 1;
+      runDefaultPolicy(kDefaultPolicies[rng() % num_policies], SolverParam(), &game, 0, nullptr);
+    }
+    // wrapped cells per time step from the root. rollouts run to the end, so it is higher for earlier finishes.
+    const double rate = double(root.countUnwrapped() - game.countUnwrapped()) / std::max(1, game.time - root.time);
+    max_rate = std::max(max_rate, rate);
+    for (int n : path) {
+      ++nodes[n].visits;
+      nodes[n].total += rate;
+    }
+  }
+
+  // goals, visits and reward sums of the root children.
+  std::vector<Node> rootChildren() const {
+    if (nodes[0].first_child < 0) return {};
+    return std::vector<Node>(nodes.begin() + nodes[0].first_child, nodes.begin() + nodes[0].first_child + nodes[0].num_children);
+  }
+
+  static int decidingWrapper(const Game& game, int decision) {
+    return decision % game.wrappers.size();
+  }
+
+private:
+  void expand(int node, const Game& game, MacroPolicy& policy, int d) {
+    const int index = decidingWrapper(game, d);
+    const auto goals = candidateGoals(game, *game.wrappers[index], policy.goalOf(index));
+    nodes[node].first_child = nodes.size();
+    nodes[node].num_children = goals.size();
+    for (auto& g : goals) {
+      nodes.emplace_back();
+      nodes.back().goal = g;
+    }
+  }
+
+  // UCB1 on rewards normalized by the best rate so far. unvisited children first.
+  int select(int node) const {
+    int best = -1;
+    double best_score = -std::numeric_limits<double>::infinity();
+    for (int c = nodes[node].first_child; c < nodes[node].first_child + nodes[node].num_children; ++c) {
+      if (nodes[c].duplicate) continue;
+      if (nodes[c].visits == 0) return c;
+      const double mean = nodes[c].total / nodes[c].visits / std::max(max_rate, 1e-9);
+      const double score = mean + kExploration * std::sqrt(std::log(nodes[node].visits + 1) / nodes[c].visits);
+      if (score > best_score) {
+        best = c;
+        best_score = score;
+      }
+    }
+    return best;
+  }
+
+  const Game& root;
+  const MacroPolicy& root_policy;
+  const int decision;
+  std::mt19937 rng;
+  std::vector<Node> nodes;
+  TranspositionTable visited;
+  double max_rate = 0;
+};
+
+double now() {
+  return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// the most visited goal over the trees of all threads. (ties: the better mean, then the earlier candidate)
+Goal searchGoal(const Game& game, const MacroPolicy& policy, int decision, int num_threads, unsigned seed, double search_deadline) {
+  std::vector<std::vector<Node>> children(num_threads);
+  auto work = [&](int t) {
+    SearchTree tree(game, policy, decision, seed + decision * num_threads + t);
+    for (int i = 0; ; ++i) {
+      const bool has_deadline = std::isfinite(search_deadline);
+      if (!has_deadline && i >= kIterationsWithoutDeadline) break;
+      // at least one iteration to have a root.
+      if (has_deadline && i > 0 && now() >= search_deadline) break;
+      tree.iterate();
+    }
+    children[t] = tree.rootChildren();
+  };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) threads.emplace_back(work, t);
+  for (auto& th : threads) th.join();
+
+  std::vector<Node> merged = children[0];
+  for (int t = 1; t < num_threads; ++t) {
+    for (int c = 0; c < merged.size() && c < children[t].size(); ++c) {
+      merged[c].visits += children[t][c].visits;
+      merged[c].total += children[t][c].total;
+    }
+  }
+  int best = -1;
+  for (int c = 0; c < merged.size(); ++c) {
+    if (merged[c].visits == 0) continue;
+    if (best < 0 || merged[c].visits > merged[best].visits ||
+        (merged[c].visits == merged[best].visits && merged[c].total > merged[best].total)) {
+      best = c;
+    }
+  }
+  return best < 0 ? Goal() : merged[best].goal;
+}
+
+} // namespace
+
+std::string mctsSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
+  const int num_threads = param.num_threads > 0 ? param.num_threads : std::max<int>(1, std::thread::hardware_concurrency());
+  const double budget = param.remainingSeconds(); // +inf without a deadline.
+  const int initial_unwrapped = game->countUnwrapped();
+  const int initial_time = game->time;
+
+  MacroPolicy policy;
+  for (int decision = 0; !game->isEnd(); ++decision) {
+    double search_deadline = std::numeric_limits<double>::infinity();
+    if (param.hasDeadline()) {
+      const double remaining = param.remainingSeconds() - budget * kFinishReserve;
+      if (remaining <= 0) break;
+      // spread the time over the decisions left, estimated by the wrapping rate so far.
+      const double rate = std::max(1.0, double(initial_unwrapped - game->countUnwrapped()) / std::max(1, game->time - initial_time));
+      const double decisions_left = game->countUnwrapped() / rate / kSegmentTicks + 1;
+      search_deadline = now() + remaining / decisions_left;
+    }
+    Goal& goal = policy.goalOf(SearchTree::decidingWrapper(*game, decision));
+    if (goal.type == kSweep) goal = searchGoal(*game, policy, decision, num_threads, param.seed, search_deadline); // otherwise no choice.
+    if (!policy.run(param, game, kSegmentTicks, iter_callback)) return game->getCommand();
+  }
+
+  if (!game->isEnd()) {
+    runDefaultPolicy(kDefaultPolicies[0], param, game, 0, iter_callback);
+  }
+  return game->getCommand();
+}
+
+REGISTER_SOLVER("mcts", mctsSolver);
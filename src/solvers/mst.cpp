@@ -3,7 +3,6 @@
 #include <limits>
 #include <cctype>
 #include <cmath>
-#include <queue>
 #include <random>
 
 #include "map_parse.h"
@@ -18,49 +17,94 @@ using namespace std;
 
 namespace {
   
-typedef int Weight;
-struct Edge {
-  int src, dst;
-  Weight weight;
-  Edge(int src, int dst, Weight weight) :
-    src(src), dst(dst), weight(weight) { }
-};
-bool operator < (const Edge& e, const Edge& f) {
-  return e.weight != f.weight ? e.weight > f.weight : // !!INVERSE!!
-  e.src != f.src ? e.src < f.src : e.dst < f.dst;
-}
-typedef vector<Edge> Edges;
-typedef vector<Edges> Graph;
-
-Graph graph;
-Game* game;
-std::vector<Point> route;
-
-pair<Weight, Edges> minimumSpanningTree(const Graph& g, int r = 0) {
-  int n = g.size();
-  Edges T;
-  Weight total = 0;
-
-  vector<bool> visited(n);
-  std::priority_queue<Edge> Q;
-  Q.push(Edge(-1, r, 0));
-  while (!Q.empty()) {
-    Edge e = Q.top(); Q.pop();
-    if (visited[e.dst]) continue;
-    T.push_back(e);
-    total += e.weight;
-    visited[e.dst] = true;
-    for (const auto& f : g[e.dst]) if (!visited[f.dst]) Q.push(f);
+// per thread so that restartSolver() can run it concurrently.
+thread_local Game* game;
+// cell indices (y * W + x) in the DFS order of the spanning tree.
+thread_local std::vector<int> route;
+
+// set of cell indices with the maximum query. 64-ary tree of bit words.
+class MaxIndexSet {
+public:
+  explicit MaxIndexSet(int n) {
+    do {
+      n = (n + 63) / 64;
+      levels.emplace_back(n, 0);
+    } while (n > 1);
+  }
+  bool empty() const { return levels.back()[0] == 0; }
+  void insert(int i) {
+    for (auto& level : levels) {
+      level[i >> 6] |= uint64_t(1) << (i & 63);
+      i >>= 6;
+    }
+  }
+  void erase(int i) {
+    for (auto& level : levels) {
+      level[i >> 6] &= ~(uint64_t(1) << (i & 63));
+      if (level[i >> 6] != 0) break;
+      i >>= 6;
+    }
+  }
+  int max() const {
+    int i = 0;
+    for (int l = levels.size() - 1; l >= 0; --l) {
+      i = (i << 6) | (63 - __builtin_clzll(levels[l][i]));
+    }
+    return i;
   }
-  return pair<Weight, Edges>(total, T);
-}
 
-int toIndex(int x, int y) {
-  return y * game->map2d.W + x;
-}
+private:
+  std::vector<std::vector<uint64_t>> levels; // levels[0] is the leaves.
+};
 
-int toIndex(const Point& p) {
-  return toIndex(p.x, p.y);
+// spanning tree of the free cells reachable from root, flattened by DFS.
+// it is the tree of Prim's algorithm popping the edge with the largest (src, dst) among unit weights:
+// the largest visited cell with an unvisited neighbor is extended to its largest unvisited neighbor.
+// children are visited in the reverse order of their addition.
+std::vector<int> spanningTreeRoute(const Map2D& map, Point root) {
+  const int W = map.W, H = map.H, n = W * H;
+  std::vector<uint8_t> visited(n, 0);
+  for (int i = 0; i < n; ++i) {
+    visited[i] = (map.data[i] & CellType::kObstacleBit) != 0;
+  }
+  // the largest unvisited neighbor. -1 if none. (y + 1, x + 1, x - 1, y - 1 in the decreasing order of index)
+  auto largestUnvisited = [&](int v) {
+    const int x = v % W, y = v / W;
+    if (y + 1 < H && !visited[v + W]) return v + W;
+    if (x + 1 < W && !visited[v + 1]) return v + 1;
+    if (x > 0 && !visited[v - 1]) return v - 1;
+    if (y > 0 && !visited[v - W]) return v - W;
+    return -1;
+  };
+
+  // children in the order of addition.
+  std::vector<int> first_child(n, -1), last_child(n, -1), next_sibling(n, -1);
+  MaxIndexSet frontier(n);
+  const int r = root.y * W + root.x;
+  visited[r] = 1;
+  frontier.insert(r);
+  while (!frontier.empty()) {
+    const int s = frontier.max();
+    const int d = largestUnvisited(s);
+    if (d < 0) {
+      frontier.erase(s);
+      continue;
+    }
+    visited[d] = 1;
+    (last_child[s] < 0 ? first_child[s] : next_sibling[last_child[s]]) = d;
+    last_child[s] = d;
+    frontier.insert(d);
+  }
+
+  std::vector<int> result;
+  std::vector<int> stk = {r};
+  while (!stk.empty()) {
+    const int v = stk.back();
+    stk.pop_back();
+    result.push_back(v);
+    for (int c = first_child[v]; c >= 0; c = next_sibling[c]) stk.push_back(c);
+  }
+  return result;
 }
 
 Point toPoint(int index) {
@@ -68,7 +112,7 @@ Point toPoint(int index) {
 }
 
 struct WrapperEngine {
-  WrapperEngine(Game *game, int id, int next_point_index) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(0), m_next_point_index(next_point_index) { m_total_wrappers++; };
+  WrapperEngine(Game *game, int id, int next_point_index) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(game->wrappers[id]->numAddedManipulators()), m_next_point_index(next_point_index) { m_total_wrappers++; };
   Wrapper *action(double x, double y, std::vector<Trajectory> &to_go, ConnectedComponentAssignmentForParanoid& cc_assignment) {
     if (m_game->num_boosters[BoosterType::MANIPULATOR] > 0 && (m_game->num_boosters[BoosterType::MANIPULATOR] + m_total_manipulators > m_total_wrappers * m_num_manipulators)) {
       if (m_num_manipulators % 2 == 0) {
@@ -84,12 +128,12 @@ struct WrapperEngine {
       m_wrapper->move(Direction2Char(to_go[0].last_move));
       to_go.erase(to_go.begin());
     }else {
-      while ((game->map2d(route[m_next_point_index]) & CellType::kWrappedBit) != 0) {
+      while ((game->map2d.data[route[m_next_point_index]] & CellType::kWrappedBit) != 0) {
         m_next_point_index = (m_next_point_index + 1) % route.size();
       }
 
       auto pos = m_wrapper->pos;
-      auto dst = route[m_next_point_index];
+      auto dst = toPoint(route[m_next_point_index]);
       std::vector<Trajectory> trajs = map_parse::findTrajectory(*game, pos, dst, DISTANCE_INF, false, false);
 
       if (trajs.empty()) {
@@ -113,13 +157,13 @@ struct WrapperEngine {
   int m_id;
   Wrapper *m_wrapper;
   int m_num_manipulators;
-  static int m_total_manipulators;
-  static int m_total_wrappers;
+  static thread_local int m_total_manipulators;
+  static thread_local int m_total_wrappers;
   int m_next_point_index;
 };
 
-int WrapperEngine::m_total_manipulators = 0;
-int WrapperEngine::m_total_wrappers = 0;
+thread_local int WrapperEngine::m_total_manipulators = 0;
+thread_local int WrapperEngine::m_total_wrappers = 0;
 };
 
 static std::vector<std::vector<Trajectory>> getItemMatrixpick(Game* game, const int mask, const int max_dist = DISTANCE_INF, bool onlyzero = true){
@@ -140,72 +184,18 @@ static std::vector<std::vector<Trajectory>> getItemMatrixpick(Game* game, const
 std::string mstSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
   ::game = game;
 
-  std::random_device seed_gen;
-  std::mt19937 engine(seed_gen());
-
-  int W = game->map2d.W;
-  int H = game->map2d.H;
-  constexpr int DX[] = { 0, -1, 0, 1};
-  constexpr int DY[] = { -1, 0, 1, 0};
-  graph.resize(W * H);
-  for (int x = 0; x < W; ++x) {
-    for (int y = 0; y < H; ++y) {
-      if ((game->map2d(x, y) & CellType::kObstacleBit) != 0) {
-        continue;
-      }
+  SolverRandom& engine = solverRandom();
 
-      for (int dir = 0; dir < 4; ++dir) {
-        int xx = x + DX[dir];
-        int yy = y + DY[dir];
-        
-        if (xx < 0 || W <= xx || yy < 0 || H <= yy) {
-          continue;
-        }
+  route = spanningTreeRoute(game->map2d, game->wrappers[0]->pos);
 
-        if ((game->map2d(xx, yy) & CellType::kObstacleBit) != 0) {
-          continue;
-        }
-
-        graph[toIndex(x, y)].emplace_back(toIndex(x, y), toIndex(xx, yy), 1);
-      }
-    }
-  }
-
-  auto mstResult = minimumSpanningTree(graph, toIndex(game->wrappers[0]->pos));
-
-  Graph mstGraph(W * H);
-  for (const auto& edge : mstResult.second) {
-    if (edge.src == -1) {
-      continue;
-    }
-    mstGraph[edge.src].push_back(edge);
-  }
-
-  std::vector<int> stk;
-  std::vector<int> visited(W * H);
-  stk.push_back(toIndex(game->wrappers[0]->pos));
-  visited[toIndex(game->wrappers[0]->pos)] = true;
-  while (!stk.empty()) {
-    int from = stk.back();
-    stk.pop_back();
-    route.push_back(toPoint(from));
-
-    for (const auto& edge : mstGraph[from]) {
-      if (visited[edge.dst]) {
-        continue;
-      }
-
-      visited[edge.dst] = true;
-      stk.push_back(edge.dst);
-    }
-  }
-
-  int num_wrappers = 1;
+  int num_wrappers = game->wrappers.size();
   vector<WrapperEngine> ws;
   bool clone_mode = false;
-  ws.emplace_back(WrapperEngine(game, 0, 0));
+  for (int i = 0; i < game->wrappers.size(); ++i) {
+    ws.emplace_back(WrapperEngine(game, i, 0));
+  }
   int epoch(0);
-  bool clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+  bool clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
   std::vector<std::vector<Trajectory>> cmat;
   cmat = std::vector<std::vector<Trajectory>>(game->wrappers.size());
 
@@ -223,7 +213,7 @@ std::string mstSolver(SolverParam param, Game* game, SolverIterCallback iter_cal
 
 //    cout << epoch << ": ";
     //cout<<*game<<endl;
-    clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+    clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
 
     if(cmat.size() < game->wrappers.size()){
       cmat.resize(game->wrappers.size());
@@ -291,7 +281,7 @@ std::string mstSolver(SolverParam param, Game* game, SolverIterCallback iter_cal
     for (auto id : cloned) {
       std::vector<int> unwrapped_point_indexes;
       for (int point_index = 0; point_index < route.size(); ++point_index) {
-        if ((game->map2d(route[point_index]) & CellType::kWrappedBit) != 0) {
+        if ((game->map2d.data[route[point_index]] & CellType::kWrappedBit) != 0) {
           unwrapped_point_indexes.push_back(point_index);
         }
       }
@@ -15,9 +15,9 @@ using namespace std;
 namespace {
 
 struct WrapperEngine {
-  WrapperEngine(Game *game, int id, int iter) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(0) { 
-    m_dstart = rand() % 2 == 0;
-    m_astart = rand() % 2 == 0;
+  WrapperEngine(Game *game, int id, int iter) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(game->wrappers[id]->numAddedManipulators()) { 
+    m_dstart = solverRandom()() % 2 == 0;
+    m_astart = solverRandom()() % 2 == 0;
     m_total_wrappers++; 
   }
   Wrapper *action(double x, double y, std::vector<Trajectory> &to_go, ConnectedComponentAssignmentForParanoid& cc_assignment) {
@@ -74,12 +74,12 @@ struct WrapperEngine {
   int m_num_manipulators;
   bool m_dstart = false;
   bool m_astart = false;
-  static int m_total_manipulators;
-  static int m_total_wrappers;
+  static thread_local int m_total_manipulators;
+  static thread_local int m_total_wrappers;
 };
 
-int WrapperEngine::m_total_manipulators = 0;
-int WrapperEngine::m_total_wrappers = 0;
+thread_local int WrapperEngine::m_total_manipulators = 0;
+thread_local int WrapperEngine::m_total_wrappers = 0;
 };
 
 static std::vector<std::vector<Trajectory>> getItemMatrixpick(Game* game, std::vector<WrapperEngine>& ws, const int mask, const int max_dist = DISTANCE_INF, bool onlyzero = true){
@@ -119,86 +119,17 @@ static bool no_spawner(Game* game, const std::vector<std::vector<Trajectory>> &c
   return true;
 }
 
-static std::vector<Trajectory> getTrajClone(Game* game, std::vector<WrapperEngine>& ws, const int wid, const std::vector<std::vector<Trajectory>> &cmat, const int max_dist){
-  
-  // 他のwrapperの計画を見た上で割り振るジョブをキメる
-  
-  // 取得予約済みのアイテムの種類と場所
-  std::vector<int> res_item;
-  std::vector<Point> res_point;
-
-  // 取りに行くアイテム
-  int target_item = CellType::kBoosterCloningBit;
-  bool spawner = false;
-  int clone_cnt = 0;
-  for(auto &cm : cmat){
-    if(cm.size()>0){
-      const Point pt = cm[cm.size()-1].pos;
-      res_item.push_back(game->map2d(pt.x, pt.y));
-      if(game->map2d(pt.x, pt.y) & CellType::kSpawnPointBit){
-	spawner = true;
-      }
-      if(game->map2d(pt.x, pt.y) & CellType::kBoosterCloningBit){
-	clone_cnt += 1;
-      }
-      res_point.push_back(pt);
-    }
-  }
-
-  if(clone_cnt == (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size())){
-    return std::vector<Trajectory>(0);
-  }
-    
-  const int wsize = game->wrappers.size();
-  for(int j=0;j<wsize;++j){
-    const Point pt = game->wrappers[j]->pos;
-    if(game->map2d(pt.x, pt.y) & CellType::kSpawnPointBit){
-      spawner = true;
-    } 
-  }
-  
-  if(!spawner && game->num_boosters[BoosterType::CLONING] > 0){
-    cout<<"no spawner found"<<endl;
-    target_item = CellType::kSpawnPointBit;
-  }
-
-
-  for(int i=0;i<res_point.size();++i){
-    // 取得済みアイテムを消した上で探索(とても危ない)
-    game->map2d(res_point[i].x, res_point[i].y) = CellType::kWrappedBit;
-  }
-  
-  std::vector<Trajectory> trajs = map_parse::findNearestByBit(*game, game->wrappers[wid]->pos, max_dist, target_item, ws[wid].m_dstart, ws[wid].m_astart);
-
-  for(int i=0;i<res_point.size();++i){
-    // 取得済みアイテムを戻す(とても危ない)
-    game->map2d(res_point[i].x, res_point[i].y) = res_item[i];
-  }
-
-  // debug
-  /*
-  for(auto traj : trajs){
-    cout<<traj<<" ";
-  }
-  cout<<endl;
-  */
-
-  if(trajs.size()>0){
-    cout<<"multispawn "<<wid<<","<<trajs.size()<<endl;
-  }
-  return trajs;
-}
-
-
 std::string multispawnSolverSub(SolverParam param, Game* game, SolverIterCallback iter_callback, int iter) {
-  int num_wrappers = 1;
+  int num_wrappers = game->wrappers.size();
   vector<WrapperEngine> ws;
   
   bool clone_mode = (game->num_boosters[BoosterType::CLONING] > 0);
-  ws.emplace_back(WrapperEngine(game, 0, iter));
+  for (int i = 0; i < game->wrappers.size(); ++i) {
+    ws.emplace_back(WrapperEngine(game, i, iter));
+  }
   
   int epoch(0);
-  bool clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+  bool clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
   std::vector<std::vector<Trajectory>> cmat;
   cmat = std::vector<std::vector<Trajectory>>(game->wrappers.size());
 
@@ -216,21 +147,34 @@ std::string multispawnSolverSub(SolverParam param, Game* game, SolverIterCallbac
 
 //    cout << epoch << ": ";
     //cout<<*game<<endl;
-    clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+    clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
 
     if(cmat.size() < game->wrappers.size()){
       cmat.resize(game->wrappers.size());
     }
 
-    for(int i=0; i<game->wrappers.size();++i){
-      //cout<<cmat[i].size()<<endl;
-      if(clone_exist && cmat[i].size()==0){
-	//cout<<"trajclone"<<endl;
-	cmat[i] = getTrajClone(game, ws, i, cmat, DISTANCE_INF);
-      }else if(game->num_boosters[BoosterType::CLONING] > 0 && no_spawner(game, cmat) && cmat.size()==1){
-	// spawnができるのにspawnしようとしている駒が居ない場合、wrapperのtrajを上書きする
-	cout<<"check no spawner"<<endl;
-	cmat[i] = getTrajClone(game, ws, i, cmat, DISTANCE_INF);
+    {
+      std::vector<int> wids;
+      for(int i=0; i<game->wrappers.size();++i){
+        //cout<<cmat[i].size()<<endl;
+        if(clone_exist && cmat[i].size()==0){
+          //cout<<"trajclone"<<endl;
+          wids.push_back(i);
+        }else if(game->num_boosters[BoosterType::CLONING] > 0 && no_spawner(game, cmat) && cmat.size()==1){
+          // spawnができるのにspawnしようとしている駒が居ない場合、wrapperのtrajを上書きする
+          cout<<"check no spawner"<<endl;
+          wids.push_back(i);
+        }
+      }
+      if(!wids.empty()){
+        std::vector<map_parse::SearchSource> sources;
+        for(int wid : wids){
+          sources.push_back({game->wrappers[wid]->pos, wid, ws[wid].m_dstart, ws[wid].m_astart});
+        }
+        auto trajs = getTrajClones(*game, sources, cmat, DISTANCE_INF, param.allocate_pairs_first);
+        for(int k=0;k<wids.size();++k){
+          cmat[wids[k]] = trajs[k];
+        }
       }
     }
     // neighbor item search
@@ -290,32 +234,7 @@ std::string multispawnSolverSub(SolverParam param, Game* game, SolverIterCallbac
 }
 
 std::string multispawnSolver(SolverParam param, Game* game_org, SolverIterCallback iter_callback) {
-  srand(3333);
-
-  std::unique_ptr<Game> best_game;
-  int best_time = std::numeric_limits<int>::max();
-
-  for (int iter = 0; iter < 2; ++iter) {
-    auto copied_game = std::make_unique<Game>(*game_org);
-    //std::cerr << iter << " " << copied_game->wrappers.size() << std::endl;
-    multispawnSolverSub(param, copied_game.get(), iter_callback, iter);
-    if (copied_game->isEnd()) {
-      //std::cerr << "ITER " << iter << " => " << copied_game->time << std::endl;
-      //std::cerr << "Command: " << copied_game->getCommand() << std::endl;
-      //std::cerr << iter << " " << copied_game->wrappers.size() << std::endl;
-      if (copied_game->time < best_time) {
-        best_time = copied_game->time;
-        best_game = std::move(copied_game);
-      }
-    }
-  }
-
-  if (best_game) {
-    *game_org = *best_game.get();
-    //std::cerr << "Command: " << game_org->getCommand() << std::endl;
-    //std::cerr << game_org->wrappers.size() << std::endl;
-  }
-  return game_org->getCommand();
+  return restartSolver(param, game_org, iter_callback, 2, multispawnSolverSub);
 }
 
 REGISTER_SOLVER("multispawn", multispawnSolver);
@@ -15,9 +15,9 @@ using namespace std;
 namespace {
 
 struct WrapperEngine {
-  WrapperEngine(Game *game, int id, int iter) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(0) { 
-    m_dstart = rand() % 2 == 0;
-    m_astart = rand() % 2 == 0;
+  WrapperEngine(Game *game, int id, int iter) : m_game(game), m_id(id), m_wrapper(game->wrappers[id].get()), m_num_manipulators(game->wrappers[id]->numAddedManipulators()) { 
+    m_dstart = solverRandom()() % 2 == 0;
+    m_astart = solverRandom()() % 2 == 0;
     m_total_wrappers++; 
   }
   Wrapper *action(double x, double y, std::vector<Trajectory> &to_go, ConnectedComponentAssignmentForParanoid& cc_assignment) {
@@ -74,12 +74,12 @@ struct WrapperEngine {
   int m_num_manipulators;
   bool m_dstart = false;
   bool m_astart = false;
-  static int m_total_manipulators;
-  static int m_total_wrappers;
+  static thread_local int m_total_manipulators;
+  static thread_local int m_total_wrappers;
 };
 
-int WrapperEngine::m_total_manipulators = 0;
-int WrapperEngine::m_total_wrappers = 0;
+thread_local int WrapperEngine::m_total_manipulators = 0;
+thread_local int WrapperEngine::m_total_wrappers = 0;
 };
 
 static std::vector<std::vector<Trajectory>> getItemMatrixpick(Game* game, std::vector<WrapperEngine>& ws, const int mask, const int max_dist = DISTANCE_INF, bool onlyzero = true){
@@ -98,14 +98,16 @@ static std::vector<std::vector<Trajectory>> getItemMatrixpick(Game* game, std::v
 }
 
 std::string pickStrictParanoidsSolverSub(SolverParam param, Game* game, SolverIterCallback iter_callback, int iter) {
-  int num_wrappers = 1;
+  int num_wrappers = game->wrappers.size();
   vector<WrapperEngine> ws;
   
   bool clone_mode = (game->num_boosters[BoosterType::CLONING] > 0);
-  ws.emplace_back(WrapperEngine(game, 0, iter));
+  for (int i = 0; i < game->wrappers.size(); ++i) {
+    ws.emplace_back(WrapperEngine(game, i, iter));
+  }
   
   int epoch(0);
-  bool clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+  bool clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
   std::vector<std::vector<Trajectory>> cmat;
   cmat = std::vector<std::vector<Trajectory>>(game->wrappers.size());
 
@@ -123,7 +125,7 @@ std::string pickStrictParanoidsSolverSub(SolverParam param, Game* game, SolverIt
 
 //    cout << epoch << ": ";
     //cout<<*game<<endl;
-    clone_exist = (enumerateCellsByMask(game->map2d, CellType::kBoosterCloningBit, CellType::kBoosterCloningBit).size() > 0);
+    clone_exist = !game->booster_index.empty(CellType::kBoosterCloningBit);
 
     if(cmat.size() < game->wrappers.size()){
       cmat.resize(game->wrappers.size());
@@ -198,32 +200,7 @@ std::string pickStrictParanoidsSolverSub(SolverParam param, Game* game, SolverIt
 }
 
 std::string pickStrictParanoidsSolver(SolverParam param, Game* game_org, SolverIterCallback iter_callback) {
-  srand(3333);
-
-  std::unique_ptr<Game> best_game;
-  int best_time = std::numeric_limits<int>::max();
-
-  for (int iter = 0; iter < 2; ++iter) {
-    auto copied_game = std::make_unique<Game>(*game_org);
-    //std::cerr << iter << " " << copied_game->wrappers.size() << std::endl;
-    pickStrictParanoidsSolverSub(param, copied_game.get(), iter_callback, iter);
-    if (copied_game->isEnd()) {
-      //std::cerr << "ITER " << iter << " => " << copied_game->time << std::endl;
-      //std::cerr << "Command: " << copied_game->getCommand() << std::endl;
-      //std::cerr << iter << " " << copied_game->wrappers.size() << std::endl;
-      if (copied_game->time < best_time) {
-        best_time = copied_game->time;
-        best_game = std::move(copied_game);
-      }
-    }
-  }
-
-  if (best_game) {
-    *game_org = *best_game.get();
-    //std::cerr << "Command: " << game_org->getCommand() << std::endl;
-    //std::cerr << game_org->wrappers.size() << std::endl;
-  }
-  return game_org->getCommand();
+  return restartSolver(param, game_org, iter_callback, 2, pickStrictParanoidsSolverSub);
 }
 
 REGISTER_SOLVER("pick_strict_paranoids", pickStrictParanoidsSolver);
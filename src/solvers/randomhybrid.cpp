@@ -2,6 +2,7 @@
 #include <sstream>
 #include <cctype>
 #include <cstdlib>
+#include <thread>
 
 #include "map_parse.h"
 #include "solver_registry.h"
@@ -18,16 +19,57 @@ T getEnv(std::string name, T default_value) {
 }
 
 
+namespace {
+
+// cumulative wrapped cells after each tick of a speculative run. (empty if the game has already ended)
+struct Speculation {
+  std::unique_ptr<Game> game;
+  std::vector<int> wrapped;
+
+  int at(int t) const { return wrapped.empty() ? 0 : wrapped[std::min<int>(t, wrapped.size() - 1)]; }
+  // wrapped cells at the end, then the earlier wrapping. (a run which finishes the game stops early)
+  bool better(const Speculation& rhs, int horizon) const {
+    if (at(horizon - 1) != rhs.at(horizon - 1)) return at(horizon - 1) > rhs.at(horizon - 1);
+    long long area = 0, rhs_area = 0;
+    for (int t = 0; t < horizon; ++t) {
+      area += at(t);
+      rhs_area += rhs.at(t);
+    }
+    return area > rhs_area;
+  }
+};
+
+// the best candidate in ticks [0, t]. ties go to |current|, then to the earlier one.
+int leader(const std::vector<Speculation>& specs, int t, int current) {
+  int best = current;
+  for (int j = 0; j < specs.size(); ++j) {
+    if (specs[j].better(specs[best], t + 1)) best = j;
+  }
+  return best;
+}
+
+} // namespace
+
+// every DIVERGE_STEP ticks, each candidate engine runs for the horizon on its own copy of the game,
+// concurrently, and the copy of the best one is adopted. the horizon starts from SEARCH_STEP and
+// follows the tick where the leader stopped changing. (short if the engines diverge quickly)
+// iter_callback sees only the adopted game: every tick of the selected engine, and once after each
+// adoption. (it is not called on the copies, since it may have side effects such as checkpoints)
+// so a stop requested by it takes effect up to one horizon late. param.deadline is checked on every tick
+// of the copies too, and the selected engine finishes the game without speculation after it.
 std::string randomHybridSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
   const int auto_diverge_step = std::max(30, int(game->countUnwrapped() * 0.01));
   const int DIVERGE_STEP = getEnv<int>("DIVERGE_STEP", auto_diverge_step);
   const int SEARCH_STEP = getEnv<int>("SEARCH_STEP", 30);
+  const int min_search_step = std::max(1, SEARCH_STEP / 4);
+  const int max_search_step = SEARCH_STEP * 4;
 
+  // single wrapper engines which can continue a game of each other.
+  // (bfs5_plus_wipe and bfs3_plus_wipe assert in Wrapper::move)
   std::vector<std::string> solver_names = {
-    "bfs5_plus_wipe",
-    "bfs3_plus_wipe",
     "bfs3",
     "bfs2",
+    "bfs",
   };
   std::vector<SolverFunction> solvers;
   for (auto name : solver_names) {
@@ -39,18 +81,20 @@ std::string randomHybridSolver(SolverParam param, Game* game, SolverIterCallback
   }
   assert (!solvers.empty());
   int selected = 0;
+  int search_step = SEARCH_STEP;
 
   bool terminate = false;
+  auto past_deadline = [&]() { return param.hasDeadline() && param.remainingSeconds() <= 0; };
 
   while (!game->isEnd()) {
-    { // move for a while
+    { // move for a while. (to the end after the deadline)
       int i = 0;
       SolverIterCallback stop_at_step = [&](Game* g) {
         if (iter_callback && !iter_callback(g)) {
           terminate = true;
           return false;
         }
-        return (++i < DIVERGE_STEP);
+        return (++i < DIVERGE_STEP || past_deadline());
       };
       solvers[selected](param, game, stop_at_step);
     }
@@ -58,31 +102,34 @@ std::string randomHybridSolver(SolverParam param, Game* game, SolverIterCallback
       break;
     }
 
-    std::cout << "try solvers.. " << game->time << std::endl;
-    // try solvers.
-    int best_selected = selected;
-    int best_total = 0;
+    std::cout << "try solvers.. " << game->time << " (" << search_step << " steps)" << std::endl;
+    // try solvers on copies of the game. engines keep per-thread state, so every run gets a fresh thread.
+    const int unwrapped_before = game->countUnwrapped();
+    std::vector<Speculation> specs(solvers.size());
+    std::vector<std::thread> threads;
     for (int j = 0; j < solvers.size(); ++j) {
-      int i = 0;
-      int total = 0;
-      const int time_before = game->time;
-      SolverIterCallback stop_at_step = [&](Game* g) {
-        for (auto& w : game->wrappers) {
-          total += w->actions.back().wrappedCount();
-        }
-        return (++i < SEARCH_STEP);
-      };
-      // move for a while
-      solvers[j](param, game, stop_at_step);
-      // revert
-      while (game->time > time_before) {
-        game->undo();
-      }
-      if (best_total < total) {
-        best_selected = j;
-        best_total = total;
-      }
-      //std::cout << "  [" << solver_names[j] << "] = " << total << std::endl;
+      specs[j].game.reset(new Game(*game));
+      threads.emplace_back([&, j]() {
+        Speculation& spec = specs[j];
+        SolverIterCallback stop_at_step = [&](Game* g) {
+          spec.wrapped.push_back(unwrapped_before - g->countUnwrapped());
+          return (spec.wrapped.size() < search_step && !past_deadline());
+        };
+        solvers[j](param, spec.game.get(), stop_at_step);
+      });
+    }
+    for (auto& t : threads) t.join();
+
+    const int best_selected = leader(specs, search_step - 1, selected);
+    // the tick from which the leader does not change.
+    int settled = search_step - 1;
+    while (settled > 0 && leader(specs, settled - 1, selected) == best_selected) --settled;
+    search_step = std::min(max_search_step, std::max(min_search_step, 2 * (settled + 1)));
+
+    // adopt the run of the best one. (no replay)
+    *game = *specs[best_selected].game;
+    if (iter_callback && !iter_callback(game)) {
+      break;
     }
 
     if (best_selected != selected) {
@@ -93,4 +140,4 @@ std::string randomHybridSolver(SolverParam param, Game* game, SolverIterCallback
   return game->getCommand();
 }
 
-REGISTER_SOLVER("random_hybrid", randomHybridSolver);
+REGISTER_SINGLE_WRAPPER_SOLVER("random_hybrid", randomHybridSolver);
@@ -102,7 +102,7 @@ std::string simulatorSolver(SolverParam param, Game* game, SolverIterCallback it
           break;
         }
         if (c == 'T') {
-          auto targets = enumerateCellsByMask(game->map2d, CellType::kTeleportTargetBit, CellType::kTeleportTargetBit);
+          auto targets = game->booster_index.positions(CellType::kTeleportTargetBit);
           if (!targets.empty()) {
             std::cout << "targets:";
             for (auto t : targets) std::cout << t << " ";
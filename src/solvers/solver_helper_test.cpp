@@ -10,7 +10,7 @@ struct WrapperEngine : public WrapperEngineBase {
   WrapperEngine() = default;
   WrapperEngine(Game *game, Wrapper *wrapper)
     : WrapperEngineBase(game, wrapper)
-    , m_num_manipulators(0) {};
+    , m_num_manipulators(wrapper->numAddedManipulators()) {};
 
   virtual Ptr create(Game* game, Wrapper *wrapper) {
     return std::make_shared<WrapperEngine>(game, wrapper);
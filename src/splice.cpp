@@ -0,0 +1,226 @@
+#include "splice.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// time steps of the command if it wraps all cells. -1 otherwise.
+int verifiedTime(const Game& initial, const std::string& command) {
+  Game game(initial);
+  if (!replaySolution(&game, parseSolutionString(command)) || !game.isEnd()) return -1;
+  return game.time;
+}
+
+struct SpliceTask {
+  int prefix;
+  std::string engine;
+  std::string description;
+};
+
+// a run in a child process. it writes "<1 if the game ends> <time>\n", and the command if the game ends.
+struct SpliceChild {
+  pid_t pid;
+  int fd;
+  int task;
+  std::string output;
+};
+
+bool writeAll(int fd, const std::string& data) {
+  for (size_t sent = 0; sent < data.size();) {
+    const ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+} // namespace
+
+std::vector<int> findSpliceCheckpoints(const Game& initial, const SolutionCommands& commands, const std::vector<double>& fractions) {
+  Game game(initial);
+  std::vector<std::pair<int, int>> num_wrappers_at; // (time, # of wrappers)
+  auto observer = [&](const Wrapper& w, int) {
+    if (num_wrappers_at.empty() || num_wrappers_at.back().first != w.game->time) {
+      num_wrappers_at.push_back({w.game->time, int(w.game->wrappers.size())});
+    }
+  };
+  if (!replaySolution(&game, commands, observer)) return {};
+
+  std::vector<int> checkpoints;
+  const int num_wrappers = game.wrappers.size();
+  if (num_wrappers > 1) {
+    for (auto& tn : num_wrappers_at) {
+      if (tn.second == num_wrappers) {
+        checkpoints.push_back(tn.first);
+        break;
+      }
+    }
+  }
+  for (double f : fractions) {
+    const int t = static_cast<int>(f * game.time);
+    if (0 <= t && t < game.time) checkpoints.push_back(t);
+  }
+  std::sort(checkpoints.begin(), checkpoints.end());
+  checkpoints.erase(std::unique(checkpoints.begin(), checkpoints.end()), checkpoints.end());
+  return checkpoints;
+}
+
+SpliceResult spliceSolutions(const Game& initial, const std::vector<SpliceCandidate>& candidates, const SpliceParam& param) {
+  SpliceResult best;
+  std::mutex log_mutex;
+  auto log = [&](const std::string& description, int time) {
+    if (!param.verbose) return;
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::cerr << "splice: " << description << " => " << (time < 0 ? std::string("invalid") : std::to_string(time)) << std::endl;
+  };
+
+  // the candidates as they are.
+  for (auto& c : candidates) {
+    const std::string command = solutionToString(c.commands);
+    const int time = verifiedTime(initial, command);
+    log(c.name, time);
+    if (time >= 0 && (!best.valid || time < best.time)) {
+      best = { true, time, command, c.name };
+    }
+  }
+
+  std::vector<std::string> engines;
+  for (auto& e : param.engines) {
+    if (SolverRegistry<SolverFunction>::getRegistry().count(e) == 0) {
+      std::cerr << "splice: unknown engine " << e << std::endl;
+      continue;
+    }
+    engines.push_back(e);
+  }
+
+  std::vector<std::unique_ptr<Game>> prefixes;
+  std::vector<SpliceTask> tasks;
+  for (auto& c : candidates) {
+    for (int t : findSpliceCheckpoints(initial, c.commands, param.fractions)) {
+      std::unique_ptr<Game> prefix(new Game(initial));
+      if (!replaySolutionUntil(prefix.get(), c.commands, t) || prefix->time != t) continue;
+      // engines which move only the first wrapper can not continue after a clone has spawned.
+      const bool has_clones = prefix->nextWrapperIndex() > 1;
+      prefixes.push_back(std::move(prefix));
+      for (auto& e : engines) {
+        if (has_clones && SolverRegistry<SolverFunction>::getRegistry().at(e).single_wrapper) continue;
+        tasks.push_back({int(prefixes.size()) - 1, e, c.name + "@" + std::to_string(t) + "+" + e});
+      }
+    }
+  }
+
+  // runs which become longer than the best are terminated. the bound is shared with the child processes.
+  void* shared = mmap(nullptr, sizeof(std::atomic<int>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  std::atomic<int> local_best_time;
+  std::atomic<int>* best_time = shared == MAP_FAILED ? &local_best_time : new (shared) std::atomic<int>;
+  best_time->store(best.valid ? best.time : INT_MAX);
+
+  // the engine runs on a fresh thread, since engines keep per-thread counters.
+  auto runInChild = [&](const SpliceTask& task, int fd) {
+    Game game(*prefixes[task.prefix]);
+    SolverFunction solver = SolverRegistry<SolverFunction>::getSolver(task.engine);
+    std::thread([&]() {
+      solver(param.solver_param, &game, [&](Game* g) { return g->time <= best_time->load(); });
+    }).join();
+    const bool ok = writeAll(fd, std::to_string(int(game.isEnd())) + " " + std::to_string(game.time) + "\n") &&
+                    (!game.isEnd() || writeAll(fd, game.getCommand()));
+    std::cout.flush();
+    _exit(ok ? 0 : 1);
+  };
+
+  std::vector<SpliceResult> results(tasks.size());
+  auto finish = [&](SpliceChild& child) {
+    int status = 0;
+    close(child.fd);
+    waitpid(child.pid, &status, 0);
+    const SpliceTask& task = tasks[child.task];
+    // an engine which asserts or crashes only loses its own run.
+    const bool exited = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!exited && param.verbose) {
+      std::lock_guard<std::mutex> lock(log_mutex);
+      std::cerr << "splice: " << task.description << " exited abnormally (status " << status << ")" << std::endl;
+    }
+    const size_t eol = child.output.find('\n');
+    if (!exited || eol == std::string::npos) {
+      log(task.description, -1);
+      return;
+    }
+    if (child.output[0] != '1') {
+      // terminated because it became longer than the best.
+      if (param.verbose) {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cerr << "splice: " << task.description << " => stopped at " << child.output.substr(2, eol - 2) << std::endl;
+      }
+      return;
+    }
+    const std::string command = child.output.substr(eol + 1);
+    const int time = verifiedTime(initial, command);
+    log(task.description, time);
+    if (time < 0) return;
+    results[child.task] = { true, time, command, task.description };
+    for (int b = best_time->load(); time < b && !best_time->compare_exchange_weak(b, time);) {}
+  };
+
+  // every run is a child process, so that an assertion in one engine does not take down the others.
+  int num_threads = param.num_threads > 0 ? param.num_threads : std::thread::hardware_concurrency();
+  num_threads = std::max(num_threads, 1);
+  std::vector<SpliceChild> running;
+  for (int next = 0; next < tasks.size() || !running.empty();) {
+    while (running.size() < num_threads && next < tasks.size()) {
+      const int k = next++;
+      int fds[2];
+      if (pipe(fds) != 0) {
+        log(tasks[k].description, -1);
+        continue;
+      }
+      std::cout.flush();
+      std::cerr.flush();
+      const pid_t pid = fork();
+      if (pid == 0) {
+        close(fds[0]);
+        runInChild(tasks[k], fds[1]);
+      }
+      close(fds[1]);
+      if (pid < 0) {
+        close(fds[0]);
+        log(tasks[k].description, -1);
+        continue;
+      }
+      running.push_back({pid, fds[0], k, ""});
+    }
+    if (running.empty()) continue;
+
+    std::vector<pollfd> pfds;
+    for (auto& child : running) pfds.push_back({child.fd, POLLIN, 0});
+    if (poll(pfds.data(), pfds.size(), -1) < 0) continue; // EINTR
+    for (int i = running.size() - 1; i >= 0; --i) {
+      if (pfds[i].revents == 0) continue;
+      char chunk[4096];
+      const ssize_t n = read(running[i].fd, chunk, sizeof(chunk));
+      if (n > 0) {
+        running[i].output.append(chunk, n);
+        continue;
+      }
+      finish(running[i]); // EOF: the child has exited or is exiting.
+      running.erase(running.begin() + i);
+    }
+  }
+  if (shared != MAP_FAILED) munmap(shared, sizeof(std::atomic<int>));
+
+  for (auto& r : results) {
+    if (r.valid && (!best.valid || r.time < best.time)) best = r;
+  }
+  return best;
+}
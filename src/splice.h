@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "game.h"
+#include "solution.h"
+#include "solver_registry.h"
+
+// combine the first part of a solution with other engines.
+// each candidate is replayed to its checkpoints, and every engine continues from a copy of the state.
+struct SpliceCandidate {
+  std::string name;
+  SolutionCommands commands;
+};
+
+struct SpliceParam {
+  std::vector<std::string> engines;
+  std::vector<double> fractions; // extra checkpoints at the fractions of the candidate's time steps.
+  int num_threads = 0;           // concurrent runs (child processes). 0: std::thread::hardware_concurrency()
+  SolverParam solver_param;
+  bool verbose = false;
+};
+
+struct SpliceResult {
+  bool valid = false;
+  int time = 0;
+  std::string command;
+  std::string description; // <candidate>@<checkpoint>+<engine>, or <candidate> if it is not spliced.
+};
+
+// checkpoints of a solution. the time when the last clone spawned (if any clone) and the fractions.
+std::vector<int> findSpliceCheckpoints(const Game& initial, const SolutionCommands& commands, const std::vector<double>& fractions);
+
+// the best of the candidates and all spliced solutions. every solution is verified by replay.
+SpliceResult spliceSolutions(const Game& initial, const std::vector<SpliceCandidate>& candidates, const SpliceParam& param);
@@ -37,3 +37,65 @@ TEST(MapParseTest, TrajectoryTest) {
     EXPECT_EQ(2, trajs.size());
   }
 }
+
+TEST(MapParseTest, FindNearestUnwrappedAStar) {
+  std::vector<std::string> test_map {
+    "                    ",
+    " ################## ",
+    " #.               # ",
+    " ################ # ",
+    "                    ",
+  };
+  Game game(test_map);
+  // wrapper cell (0, 0) is wrapped. the target is (2, 2) through the corridor.
+  std::vector<Trajectory> bfs = map_parse::findTrajectory(game, {0,0}, {2,2}, DISTANCE_INF);
+  std::vector<Trajectory> trajs = map_parse::findNearestUnwrappedAStar(game, {0,0}, DISTANCE_INF);
+  ASSERT_EQ(bfs.size(), trajs.size());
+  EXPECT_EQ(Point(2, 2), trajs.back().pos);
+  EXPECT_EQ(2 * trajs.size() - 1, trajs.back().distance);
+
+  // findNearestUnwrapped() gives the same length.
+  EXPECT_EQ(trajs.size(), map_parse::findNearestUnwrapped(game, {0,0}, DISTANCE_INF).size());
+  // out of max_dist.
+  EXPECT_TRUE(map_parse::findNearestUnwrappedAStar(game, {0,0}, 10).empty());
+}
+
+TEST(MapParseTest, ReservationAndAllocation) {
+  std::vector<std::string> test_map {
+    "C   C",
+    "     ",
+    "  C  ",
+  };
+  Game game(test_map);
+  const Point center(2, 0);
+  const Map2D original = game.map2d;
+
+  map_parse::ReservationTable reservation(game.map2d);
+  EXPECT_TRUE(reservation.reserve(center, 0));
+  EXPECT_FALSE(reservation.reserve(center, 1));
+  // the reserved C under the wrapper is skipped.
+  auto trajs = map_parse::findNearestByBit(game, {2, 1}, DISTANCE_INF, CellType::kBoosterCloningBit, reservation);
+  ASSERT_FALSE(trajs.empty());
+  EXPECT_NE(center, trajs.back().pos);
+  reservation.clear();
+  EXPECT_FALSE(reservation.isReserved(center));
+
+  // 4 sources for 3 Cs. the nearest pairs are fixed first.
+  std::vector<map_parse::SearchSource> sources = {
+    {{1, 1}, 0},
+    {{0, 1}, 1},
+    {{3, 1}, 2},
+    {{4, 0}, 3},
+  };
+  auto res = map_parse::allocateNearestByBit(game, sources, DISTANCE_INF, CellType::kBoosterCloningBit, reservation);
+  ASSERT_EQ(4, res.size());
+  EXPECT_EQ(Point(0, 2), res[1].back().pos);
+  EXPECT_EQ(3, reservation.reservedCells().size());
+  for (int k = 0; k < 4; ++k) {
+    if (res[k].empty()) continue;
+    EXPECT_EQ(k, reservation.owner(res[k].back().pos));
+  }
+  // one of the sources gets nothing, and the map is untouched.
+  EXPECT_EQ(1, std::count_if(res.begin(), res.end(), [](const std::vector<Trajectory>& t) { return t.empty(); }));
+  EXPECT_EQ(original, game.map2d);
+}
@@ -5,6 +5,8 @@
 #include "base.h"
 #include "game.h"
 
+#include <sstream>
+
 TEST(ActionTest, SimpleMoves) {
   Game game("(0,0),(3,0),(3,5),(0,5)#(0,0)##B(0,1);F(0,2);L(0,3)");
   // ... 4
@@ -70,6 +72,39 @@ TEST(ActionTest, Clone) {
   EXPECT_EQ(Point(1, 2), wrapper_cloned->pos);
 }
 
+TEST(ActionTest, CommandBuffer) {
+  Game game("(0,0),(10,0),(10,10),(0,10)#(0,0)##B(0,1);C(0,2);X(0,3)");
+
+  Wrapper* wrapper = game.wrappers[0].get();
+  wrapper->move(Action::UP); game.tick();
+  wrapper->addManipulator({1, 2}); game.tick();
+  wrapper->move(Action::UP); game.tick();
+  wrapper->move(Action::UP); game.tick();
+  wrapper->cloneWrapper(); game.tick();
+  wrapper->turn(Action::CW);
+  game.wrappers[1]->move(Action::RIGHT);
+  game.tick();
+  EXPECT_EQ("WB(1,2)WWCE", wrapper->getCommand());
+  EXPECT_EQ("WB(1,2)WWCE#D", game.getCommand());
+  std::ostringstream oss;
+  game.writeCommand(oss);
+  EXPECT_EQ(game.getCommand(), oss.str());
+
+  // undo trims the buffers.
+  game.undo();
+  game.undo();
+  EXPECT_EQ("WB(1,2)WW", game.getCommand());
+  game.undo();
+  game.undo();
+  EXPECT_EQ("WB(1,2)", game.getCommand());
+
+  // copies keep their own buffers.
+  Game copied(game);
+  copied.wrappers[0]->move(Action::UP); copied.tick();
+  EXPECT_EQ("WB(1,2)W", copied.getCommand());
+  EXPECT_EQ("WB(1,2)", game.getCommand());
+}
+
 TEST(ActionTest, Manipulator) {
   // example-01.desc + mod.
   Game game("(0,0),(10,0),(10,10),(0,10)#(0,0)#(4,2),(6,2),(6,7),(4,7);(5,8),(6,8),(6,9),(5,9)#B(0,1);B(0,2)");
@@ -151,6 +186,39 @@ TEST(ActionTest, Drill) {
   EXPECT_EQ(1, game.map2d.num_unwrapped);
 }
 
+TEST(ActionTest, DrillUndo) {
+  Game game("(0,0),(3,0),(3,3),(0,3)#(0,0)#(1,1),(2,1),(2,2),(1,2)#L(0,1)");
+  const Map2D original = game.map2d;
+  const int num_unwrapped = game.map2d.num_unwrapped;
+
+  Wrapper* wrapper = game.wrappers[0].get();
+  wrapper->move(Action::UP); game.tick();
+  wrapper->useBooster(Action::DRILL); game.tick();
+  wrapper->move(Action::RIGHT); game.tick();
+  wrapper->move(Action::RIGHT); game.tick();
+  for (int i = 0; i < 4; ++i) game.undo();
+
+  EXPECT_EQ(original, game.map2d);
+  EXPECT_EQ(num_unwrapped, game.map2d.num_unwrapped);
+  // the summary layers are the same as freshly built ones.
+  const UnwrappedPyramid pyramid(game.map2d);
+  const PaddedObstacleMap obstacle_map(game.map2d);
+  ASSERT_EQ(pyramid.numLevels(), game.unwrapped_pyramid.numLevels());
+  for (int level = 0; level < pyramid.numLevels(); ++level) {
+    for (int ty = 0; ty <= (game.map2d.H - 1) >> level; ++ty) {
+      for (int tx = 0; tx <= (game.map2d.W - 1) >> level; ++tx) {
+        EXPECT_EQ(pyramid.tileCount(level, tx, ty), game.unwrapped_pyramid.tileCount(level, tx, ty));
+      }
+    }
+  }
+  for (int y = 0; y < game.map2d.H; ++y) {
+    for (int x = 0; x < game.map2d.W; ++x) {
+      EXPECT_EQ(obstacle_map(x, y), game.obstacle_map(x, y));
+    }
+  }
+  EXPECT_EQ(game.computeHash(), game.hash());
+}
+
 TEST(ActionTest, FastWheel) {
   Game game("(0,0),(2,0),(2,4),(0,4)#(0,0)##F(0,1);L(0,2)");
   // .. 3
@@ -0,0 +1,112 @@
+#include "../bit_grid.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+
+namespace {
+
+// reference: BFS one cell at a time. points are sorted in the raster order.
+std::vector<std::vector<Point>> scalarComponents(const Map2D& map) {
+  Map2D label(map.W, map.H, -1);
+  std::vector<std::vector<Point>> components;
+  for (int y = 0; y < map.H; ++y) {
+    for (int x = 0; x < map.W; ++x) {
+      if (map(x, y) != 0 || label(x, y) >= 0) continue;
+      std::vector<Point> component { {x, y} };
+      label(x, y) = components.size();
+      for (int i = 0; i < component.size(); ++i) {
+        for (auto d : all_directions) {
+          const Point n = component[i] + Point(d);
+          if (map.isInside(n) && map(n) == 0 && label(n) < 0) {
+            label(n) = components.size();
+            component.push_back(n);
+          }
+        }
+      }
+      std::sort(component.begin(), component.end(), [](Point a, Point b) { return std::make_pair(a.y, a.x) < std::make_pair(b.y, b.x); });
+      components.push_back(component);
+    }
+  }
+  return components;
+}
+
+Map2D randomMap(int W, int H, int obstacle_percent) {
+  Map2D map(W, H);
+  for (int y = 0; y < H; ++y) {
+    for (int x = 0; x < W; ++x) {
+      map(x, y) = std::rand() % 100 < obstacle_percent ? CellType::kObstacleBit : 0;
+    }
+  }
+  return map;
+}
+
+} // namespace
+
+TEST(BitGridTest, connectedComponents) {
+  std::srand(1);
+  for (auto size : std::vector<Point>{{1, 1}, {5, 3}, {64, 7}, {65, 9}, {150, 40}, {200, 3}}) {
+    for (int percent : {10, 35, 45, 60}) {
+      Map2D map = randomMap(size.x, size.y, percent);
+      BitGrid free = BitGrid::fromMask(map, CellType::kObstacleBit, 0);
+      EXPECT_EQ(countCellsByMask(map, CellType::kObstacleBit, 0), free.count());
+      auto expected = scalarComponents(map);
+      EXPECT_EQ(expected, connectedComponents(free)) << size << " " << percent;
+      for (auto& cc : expected) {
+        EXPECT_EQ(cc, floodFill(free, cc.back()).points());
+      }
+    }
+  }
+}
+
+TEST(BitGridTest, bfsDistance) {
+  std::srand(2);
+  for (int iter = 0; iter < 20; ++iter) {
+    Map2D map = randomMap(100, 30, 30);
+    BitGrid free = BitGrid::fromMask(map, CellType::kObstacleBit, 0);
+    const Point start(std::rand() % map.W, std::rand() % map.H);
+    const Point goal(std::rand() % map.W, std::rand() % map.H);
+    BitGrid targets(map.W, map.H);
+    targets.set(goal);
+    const bool reachable = free.get(start) && free.get(goal) && floodFill(free, start).get(goal);
+    const int expected = reachable ? int(shortestPathByMaskBFS(map, CellType::kObstacleBit, 0, start, {goal}).size()) - 1 : -1;
+    EXPECT_EQ(expected, bfsDistance(free, start, targets));
+    if (expected > 0) {
+      EXPECT_EQ(-1, bfsDistance(free, start, targets, expected - 1));
+    }
+  }
+}
+
+TEST(BitGridTest, BitGridBFSFirstStep) {
+  std::srand(3);
+  for (int iter = 0; iter < 30; ++iter) {
+    Map2D map = randomMap(70 + iter, 30, 30);
+    BitGrid free = BitGrid::fromMask(map, CellType::kObstacleBit, 0);
+    BitGridBFS bfs(free);
+    // the buffers are reused by consecutive runs.
+    for (int k = 0; k < 3; ++k) {
+      const Point start(std::rand() % map.W, std::rand() % map.H);
+      std::vector<Point> goals;
+      BitGrid targets(map.W, map.H);
+      for (int n = 0; n < 3; ++n) {
+        const Point goal(std::rand() % map.W, std::rand() % map.H);
+        if (!free.get(goal)) continue;
+        goals.push_back(goal);
+        targets.set(goal);
+      }
+      if (goals.empty()) continue;
+      const auto path = shortestPathByMaskBFS(map, CellType::kObstacleBit, 0, start, goals);
+      EXPECT_EQ(int(path.size()) - 1, bfs.run(start, targets));
+      EXPECT_EQ(path.size() >= 2 ? path[1] - path[0] : Point(0, 0), bfs.firstStep());
+    }
+  }
+}
+
+TEST(BitGridTest, expand) {
+  Map2D map(70, 2, 0);
+  BitGrid free = BitGrid::fromMask(map, CellType::kObstacleBit, 0);
+  BitGrid layer(70, 2);
+  layer.set({63, 0});
+  EXPECT_EQ((std::vector<Point>{{62, 0}, {64, 0}, {63, 1}}), layer.expand(free).points());
+}
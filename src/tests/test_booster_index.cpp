@@ -0,0 +1,59 @@
+#include "../game.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+void expectIndexMatchesMap(const Game& game) {
+  for (int bit : {CellType::kBoosterManipulatorBit, CellType::kBoosterCloningBit,
+                  CellType::kSpawnPointBit, CellType::kTeleportTargetBit}) {
+    EXPECT_EQ(enumerateCellsByMask(game.map2d, bit, bit), game.booster_index.positions(bit));
+  }
+}
+
+}
+
+TEST(BoosterIndexTest, addRemove) {
+  BoosterIndex index;
+  index.add(CellType::kBoosterCloningBit, {3, 1});
+  index.add(CellType::kBoosterCloningBit, {5, 0});
+  index.add(CellType::kBoosterCloningBit, {1, 1});
+  index.add(CellType::kBoosterCloningBit, {1, 1}); // idempotent
+  ASSERT_EQ(3, index.count(CellType::kBoosterCloningBit));
+  // raster order
+  EXPECT_EQ(Point(5, 0), index.positions(CellType::kBoosterCloningBit)[0]);
+  EXPECT_EQ(Point(1, 1), index.positions(CellType::kBoosterCloningBit)[1]);
+  EXPECT_EQ(Point(3, 1), index.positions(CellType::kBoosterCloningBit)[2]);
+  EXPECT_TRUE(index.empty(CellType::kBoosterManipulatorBit));
+
+  index.remove(CellType::kBoosterCloningBit, {1, 1});
+  index.remove(CellType::kBoosterCloningBit, {1, 1});
+  EXPECT_EQ(2, index.count(CellType::kBoosterCloningBit));
+}
+
+TEST(BoosterIndexTest, pickAndUndo) {
+  Game game(std::vector<std::string>{
+    "..C..",
+    "X.B..",
+    "@.B..",
+  });
+  expectIndexMatchesMap(game);
+  EXPECT_EQ(2, game.booster_index.count(CellType::kBoosterManipulatorBit));
+
+  Wrapper* w = game.wrappers[0].get();
+  w->move('D'); game.tick();
+  w->move('D'); game.tick();
+  expectIndexMatchesMap(game);
+
+  // B is picked at the beginning of the next action.
+  game.num_boosters[BoosterType::TELEPORT] = 1;
+  w->useBooster('R'); game.tick();
+  expectIndexMatchesMap(game);
+  EXPECT_EQ(1, game.booster_index.count(CellType::kBoosterManipulatorBit));
+  EXPECT_EQ(1, game.booster_index.count(CellType::kTeleportTargetBit));
+
+  game.undo();
+  expectIndexMatchesMap(game);
+  EXPECT_EQ(2, game.booster_index.count(CellType::kBoosterManipulatorBit));
+  EXPECT_EQ(0, game.booster_index.count(CellType::kTeleportTargetBit));
+}
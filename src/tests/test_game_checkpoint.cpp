@@ -0,0 +1,63 @@
+#include "../game.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(GameCheckpointTest, saveAndLoad) {
+  Game game(std::vector<std::string>{
+    "..C..",
+    "X.B..",
+    "@.B..",
+  });
+  game.problem_no = 42;
+  game.num_boosters[BoosterType::CLONING] = 1;
+  Wrapper* w = game.wrappers[0].get();
+  w->move('W'); game.tick();
+  w->cloneWrapper(); game.tick();
+  ASSERT_EQ(2, game.wrappers.size());
+  game.wrappers[0]->turn('E');
+  game.wrappers[1]->move('D');
+  game.tick();
+
+  std::stringstream ss;
+  game.save(ss);
+  auto loaded = Game::load(ss);
+  ASSERT_TRUE(bool(loaded));
+  EXPECT_EQ(42, loaded->problem_no);
+  EXPECT_EQ(game.time, loaded->time);
+  EXPECT_EQ(game.map2d, loaded->map2d);
+  EXPECT_EQ(game.map2d.num_unwrapped, loaded->map2d.num_unwrapped);
+  EXPECT_EQ(game.num_boosters, loaded->num_boosters);
+  EXPECT_EQ(game.getCommand(), loaded->getCommand());
+  EXPECT_EQ(game.unwrapped_pyramid.count(), loaded->unwrapped_pyramid.count());
+  EXPECT_EQ(game.booster_index.positions(CellType::kBoosterManipulatorBit),
+            loaded->booster_index.positions(CellType::kBoosterManipulatorBit));
+  ASSERT_EQ(2, loaded->wrappers.size());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(loaded.get(), loaded->wrappers[i]->game);
+    EXPECT_EQ(game.wrappers[i]->pos, loaded->wrappers[i]->pos);
+    EXPECT_EQ(game.wrappers[i]->direction, loaded->wrappers[i]->direction);
+    EXPECT_EQ(game.wrappers[i]->manipulators, loaded->wrappers[i]->manipulators);
+  }
+
+  // the action journal is restored, so both can be undone to the same state.
+  game.undo();
+  game.undo();
+  loaded->undo();
+  loaded->undo();
+  EXPECT_EQ(game.map2d, loaded->map2d);
+  EXPECT_EQ(game.getCommand(), loaded->getCommand());
+  EXPECT_EQ(1, loaded->wrappers.size());
+}
+
+TEST(GameCheckpointTest, brokenStream) {
+  Game game(std::vector<std::string>{"@.."});
+  std::stringstream ss;
+  game.save(ss);
+  const std::string data = ss.str();
+
+  std::stringstream truncated(data.substr(0, data.size() - 1));
+  EXPECT_FALSE(bool(Game::load(truncated)));
+  std::stringstream wrong_magic("X" + data.substr(1));
+  EXPECT_FALSE(bool(Game::load(wrong_magic)));
+}
@@ -0,0 +1,166 @@
+#include "../grid_graph.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+namespace {
+
+// reference: binary-heap Dijkstra over explicit edges. cells with weight 0 are never expanded.
+std::vector<int> heapDijkstraPath(int W, int H, const std::vector<int>& weights, int s, int t) {
+  std::vector<int> d(W * H, INT_MAX >> 2), prev(W * H, -1);
+  using pii = std::pair<int, int>;
+  std::priority_queue<pii, std::vector<pii>, std::greater<pii>> pq;
+  d[s] = 0;
+  pq.push({0, s});
+  while (!pq.empty()) {
+    const pii p = pq.top();
+    pq.pop();
+    const int v = p.second;
+    if (d[v] < p.first) continue;
+    const int x = v % W, y = v / W;
+    std::vector<int> neighbors;
+    if (x + 1 < W) neighbors.push_back(v + 1);
+    if (x > 0) neighbors.push_back(v - 1);
+    if (y + 1 < H) neighbors.push_back(v + W);
+    if (y > 0) neighbors.push_back(v - W);
+    for (int u : neighbors) {
+      if (weights[u] == 0 || d[u] <= d[v] + weights[u]) continue;
+      d[u] = d[v] + weights[u];
+      prev[u] = v;
+      pq.push({d[u], u});
+    }
+  }
+  std::vector<int> path;
+  if (d[t] == (INT_MAX >> 2)) return path;
+  for (int v = t; v != -1; v = prev[v]) path.push_back(v);
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+} // namespace
+
+TEST(UnionFindTest, Unite) {
+  UnionFind uf(5);
+  EXPECT_EQ(5, uf.numSets());
+  EXPECT_TRUE(uf.unite(0, 1));
+  EXPECT_TRUE(uf.unite(3, 4));
+  EXPECT_FALSE(uf.unite(1, 0));
+  EXPECT_TRUE(uf.unite(1, 4));
+  EXPECT_TRUE(uf.same(0, 3));
+  EXPECT_FALSE(uf.same(0, 2));
+  EXPECT_EQ(4, uf.size(3));
+  EXPECT_EQ(2, uf.numSets());
+}
+
+TEST(GridGraphTest, MinimumSpanningTree) {
+  // 0 - 1 - 2 in a row and 3 far away. equal costs keep the input order.
+  std::vector<WeightedEdge> edges = {
+    {0, 2, 2}, {0, 1, 1}, {1, 2, 1}, {2, 3, 5}, {0, 3, 7},
+  };
+  auto tree = minimumSpanningTree(edges, 4);
+  ASSERT_EQ(3, tree.size());
+  EXPECT_EQ(0, tree[0].from);
+  EXPECT_EQ(1, tree[0].to);
+  EXPECT_EQ(1, tree[1].from);
+  EXPECT_EQ(2, tree[1].to);
+  EXPECT_EQ(5, tree[2].cost);
+}
+
+TEST(GridGraphTest, Blocked) {
+  // . # .
+  // . # .
+  // . . .
+  GridDijkstra dijkstra(3, 3);
+  dijkstra.setWeight(dijkstra.index({1, 1}), 0);
+  dijkstra.setWeight(dijkstra.index({1, 2}), 0);
+  const int s = dijkstra.index({0, 2}), t = dijkstra.index({2, 2});
+  EXPECT_EQ(6, dijkstra.run(s, t));
+  auto path = dijkstra.path(t);
+  ASSERT_EQ(7, path.size());
+  EXPECT_EQ(s, path.front());
+  EXPECT_EQ(dijkstra.index({1, 0}), path[3]);
+  // enclosed.
+  dijkstra.setWeight(dijkstra.index({1, 0}), 0);
+  EXPECT_EQ(GridDijkstra::kInfinity, dijkstra.run(s, t));
+  EXPECT_TRUE(dijkstra.path(t).empty());
+}
+
+TEST(GridGraphTest, SameAsHeapDijkstra) {
+  std::srand(44);
+  for (int iter = 0; iter < 300; ++iter) {
+    const int W = 2 + std::rand() % 12, H = 2 + std::rand() % 12;
+    const int max_weight = 1 + std::rand() % 3;
+    GridDijkstra dijkstra(W, H, max_weight);
+    std::vector<int> weights(W * H);
+    for (int v = 0; v < W * H; ++v) {
+      weights[v] = std::rand() % 5 == 0 ? 0 : 1 + std::rand() % max_weight;
+      dijkstra.setWeight(v, weights[v]);
+    }
+    // the buffers are reused by consecutive runs.
+    for (int k = 0; k < 3; ++k) {
+      const int s = std::rand() % (W * H), t = std::rand() % (W * H);
+      dijkstra.run(s, t);
+      EXPECT_EQ(heapDijkstraPath(W, H, weights, s, t), dijkstra.path(t));
+    }
+  }
+}
+
+TEST(GridGraphTest, RunToAnyIsFirstFoundByBFS) {
+  const std::array<Point, 4> order = {{{1, 0}, {0, -1}, {-1, 0}, {0, 1}}};
+  std::srand(45);
+  for (int iter = 0; iter < 300; ++iter) {
+    const int W = 2 + std::rand() % 12, H = 2 + std::rand() % 12;
+    GridDijkstra dijkstra(W, H, 1);
+    dijkstra.setNeighborOrder(order);
+    std::vector<int> weights(W * H);
+    std::vector<uint8_t> is_target(W * H);
+    for (int v = 0; v < W * H; ++v) {
+      weights[v] = std::rand() % 5 == 0 ? 0 : 1;
+      is_target[v] = std::rand() % 20 == 0;
+      dijkstra.setWeight(v, weights[v]);
+    }
+    const int s = std::rand() % (W * H);
+    const int t = dijkstra.runToAny(s, is_target);
+
+    // BFS which stops at the first target in the queue order.
+    std::vector<int> dist(W * H, -1), queue = {s};
+    dist[s] = 0;
+    int expected = -1;
+    for (int head = 0; head < queue.size() && expected < 0; ++head) {
+      const int v = queue[head];
+      if (is_target[v]) {
+        expected = v;
+        break;
+      }
+      for (auto n : order) {
+        const Point p = dijkstra.point(v) + n;
+        if (p.x < 0 || p.x >= W || p.y < 0 || p.y >= H) continue;
+        const int u = dijkstra.index(p);
+        if (weights[u] == 0 || dist[u] >= 0) continue;
+        dist[u] = dist[v] + 1;
+        queue.push_back(u);
+      }
+    }
+    ASSERT_EQ(expected, t);
+    if (t < 0) continue;
+    // walk back to the first neighbor in the order which is one step closer.
+    std::vector<int> path = {t};
+    while (path.back() != s) {
+      const int v = path.back();
+      for (auto n : order) {
+        const Point p = dijkstra.point(v) + n;
+        if (p.x < 0 || p.x >= W || p.y < 0 || p.y >= H) continue;
+        if (dist[dijkstra.index(p)] == dist[v] - 1) {
+          path.push_back(dijkstra.index(p));
+          break;
+        }
+      }
+    }
+    std::reverse(path.begin(), path.end());
+    EXPECT_EQ(path, dijkstra.path(t));
+  }
+}
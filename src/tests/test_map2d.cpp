@@ -28,3 +28,20 @@ TEST(Map, isConnected4) {
     });
     EXPECT_TRUE(isConnected4(m3));
 }
+
+TEST(Map, isValidDescString) {
+    EXPECT_TRUE(isValidDescString("(0,0),(6,0),(6,1),(0,1)#(0,0)##"));
+    EXPECT_TRUE(isValidDescString("(0,0),(4,0),(4,4),(0,4)#(0,0)#(1,1),(2,1),(2,2),(1,2)#B(3,3);X(0,3)\n"));
+
+    std::string error;
+    EXPECT_FALSE(isValidDescString("garbage", &error));
+    EXPECT_EQ("broken map at 0", error);
+    EXPECT_FALSE(isValidDescString("(0,0),(6,0),(6,1),(0,1)#(0,0)#"));
+    EXPECT_FALSE(isValidDescString("(0,0),(6,0),(6,1),(0,1)#(0,0)##\n"));
+    EXPECT_FALSE(isValidDescString("(0,0),(6,0),(6,1),(0,1)#(0,0)##Q(1,0)"));
+    EXPECT_FALSE(isValidDescString("(0,0),(6,0),(6,1),(0,1)#(0,0)##B(6,0)"));
+    EXPECT_FALSE(isValidDescString("(0,0),(6,1),(6,1),(0,1)#(0,0)##")); // not rectilinear
+    EXPECT_FALSE(isValidDescString("(0,0),(6,0),(6,1),(0,1)#(0,0)#(5,0),(7,0),(7,1),(5,1)#")); // obstacle out of the map
+    EXPECT_FALSE(isValidDescString("(-1,0),(6,0),(6,1),(-1,1)#(0,0)##"));
+    EXPECT_FALSE(isValidDescString("(0,0),(99999,0),(99999,1),(0,1)#(0,0)##"));
+}
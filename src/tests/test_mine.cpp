@@ -0,0 +1,91 @@
+#include "../mine.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string moveRightSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
+  while (!game->isEnd()) {
+    game->wrappers[0]->move(Action::RIGHT);
+    game->tick();
+    if (iter_callback && !iter_callback(game)) break;
+  }
+  return game->getCommand();
+}
+
+// walks right and back before it finishes.
+std::string detourSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
+  game->wrappers[0]->move(Action::RIGHT);
+  game->tick();
+  game->wrappers[0]->move(Action::LEFT);
+  game->tick();
+  return moveRightSolver(param, game, iter_callback);
+}
+
+std::string giveUpSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
+  return game->getCommand();
+}
+
+PuzzleSolution squarePuzzleSolver(PuzzleSolverParam param, Puzzle puzzle) {
+  PuzzleSolution solution;
+  solution.wall = {{0, 0}, {puzzle.tSize, 0}, {puzzle.tSize, puzzle.tSize}, {0, puzzle.tSize}};
+  solution.wrapper = {1, 1};
+  return solution;
+}
+
+PuzzleSolution emptyPuzzleSolver(PuzzleSolverParam param, Puzzle puzzle) {
+  return PuzzleSolution();
+}
+
+REGISTER_SOLVER("mine_test_move_right", moveRightSolver);
+REGISTER_SOLVER("mine_test_detour", detourSolver);
+REGISTER_SOLVER("mine_test_give_up", giveUpSolver);
+REGISTER_PUZZLE_SOLVER("mine_test_square", squarePuzzleSolver);
+REGISTER_PUZZLE_SOLVER("mine_test_empty", emptyPuzzleSolver);
+
+Puzzle testPuzzle() {
+  Puzzle puzzle;
+  puzzle.tSize = 10;
+  puzzle.vMin = 4;
+  puzzle.vMax = 8;
+  puzzle.iSqs = {{5, 5}};
+  return puzzle;
+}
+
+} // namespace
+
+TEST(MineTest, mineBlock) {
+  Game task("(0,0),(6,0),(6,1),(0,1)#(0,0)##");
+  MineParam param;
+  param.puzzle_solver = "mine_test_square";
+  param.engines = {"mine_test_give_up", "mine_test_detour", "mine_test_move_right", "no_such_engine"};
+  param.num_threads = 2;
+  MineResult result = mineBlock(testPuzzle(), task, param);
+
+  EXPECT_TRUE(result.puzzle_valid);
+  EXPECT_EQ(4, result.puzzle_solution.wall.size());
+  ASSERT_TRUE(result.task_valid);
+  EXPECT_EQ("mine_test_move_right", result.task_engine);
+  EXPECT_EQ(4, result.task_time);
+  EXPECT_EQ("DDDD", result.task_command);
+}
+
+TEST(MineTest, invalidResults) {
+  Game task("(0,0),(6,0),(6,1),(0,1)#(0,0)##");
+  MineParam param;
+  param.puzzle_solver = "mine_test_empty";
+  param.engines = {"mine_test_give_up"};
+  MineResult result = mineBlock(testPuzzle(), task, param);
+  EXPECT_FALSE(result.puzzle_valid);
+  EXPECT_FALSE(result.task_valid);
+}
+
+TEST(MineTest, unknownPuzzleSolver) {
+  Game task("(0,0),(6,0),(6,1),(0,1)#(0,0)##");
+  MineParam param;
+  param.puzzle_solver = "no_such_puzzle_solver";
+  param.engines = {"mine_test_move_right"};
+  MineResult result = mineBlock(testPuzzle(), task, param);
+  EXPECT_FALSE(result.puzzle_valid);
+  EXPECT_TRUE(result.task_valid);
+}
@@ -0,0 +1,57 @@
+#include "../pack.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+const std::string kDescA = "(0,0),(6,0),(6,1),(0,1)#(0,0)##";
+const std::string kDescB = "(0,0),(10,0),(10,10),(0,10)#(0,0)#(4,2),(6,2),(6,7),(4,7);(5,8),(6,8),(6,9),(5,9)#B(0,1);B(1,1);F(0,2);F(1,2);L(0,3);X(0,9)";
+
+} // namespace
+
+TEST(PackTest, writeAndOpen) {
+  const std::string path = testing::TempDir() + "test_pack.pack";
+  ASSERT_TRUE(writeDatasetPack({{"prob-001", kDescA}, {"prob-002", kDescB}}, path));
+  auto pack = DatasetPack::open(path);
+  ASSERT_TRUE(bool(pack));
+  EXPECT_EQ(2, pack->size());
+  EXPECT_EQ("prob-002", pack->name(1));
+  EXPECT_EQ(-1, pack->find("prob-003"));
+
+  for (auto desc : {kDescA, kDescB}) {
+    const int i = pack->find(desc == kDescA ? "prob-001" : "prob-002");
+    ASSERT_LE(0, i);
+    Game expected(desc);
+    auto game = pack->makeGame(i);
+    EXPECT_EQ(expected.map2d, game->map2d);
+    EXPECT_EQ(expected.map2d.num_unwrapped, game->map2d.num_unwrapped);
+    EXPECT_EQ(expected.unwrapped_pyramid.count(), game->unwrapped_pyramid.count());
+    EXPECT_EQ(expected.booster_index.positions(CellType::kBoosterManipulatorBit),
+              game->booster_index.positions(CellType::kBoosterManipulatorBit));
+    ASSERT_EQ(1, game->wrappers.size());
+    EXPECT_EQ(expected.wrappers[0]->pos, game->wrappers[0]->pos);
+    EXPECT_EQ(game.get(), game->wrappers[0]->game);
+  }
+  pack.reset();
+  std::remove(path.c_str());
+}
+
+TEST(PackTest, brokenFile) {
+  const std::string path = testing::TempDir() + "test_pack_broken.pack";
+  ASSERT_TRUE(writeDatasetPack({{"prob-001", kDescA}}, path));
+  std::string data;
+  {
+    std::ifstream ifs(path, std::ios::binary);
+    data.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << data.substr(0, data.size() - 1);
+  }
+  EXPECT_FALSE(bool(DatasetPack::open(path)));
+  EXPECT_FALSE(bool(DatasetPack::open(path + ".missing")));
+  EXPECT_FALSE(writeDatasetPack({{std::string(32, 'a'), kDescA}}, path));
+  std::remove(path.c_str());
+}
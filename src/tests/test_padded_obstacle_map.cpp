@@ -0,0 +1,66 @@
+#include "../padded_obstacle_map.h"
+#include "../game.h"
+#include "../manipulator_reach.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+void expectSameObstacles(const Map2D& map, const PaddedObstacleMap& obstacles) {
+  const int P = PaddedObstacleMap::kPadding;
+  for (int y = -P; y < map.H + P; ++y) {
+    for (int x = -P; x < map.W + P; ++x) {
+      const int expected = !map.isInside(x, y) ? PaddedObstacleMap::kOutside
+        : (map(x, y) & CellType::kObstacleBit) ? PaddedObstacleMap::kObstacle : PaddedObstacleMap::kFree;
+      EXPECT_EQ(expected, obstacles(x, y)) << x << "," << y;
+    }
+  }
+}
+
+} // namespace
+
+TEST(PaddedObstacleMapTest, reset) {
+  constexpr int I = CellType::kObstacleBit;
+  Map2D map(3, 2, {
+    0, I, 0,
+    I, 0, CellType::kWrappedBit,
+  });
+  PaddedObstacleMap obstacles(map);
+  expectSameObstacles(map, obstacles);
+  EXPECT_EQ(obstacles.index({1, 1}) + obstacles.offset({1, 0}), obstacles.index({2, 1}));
+  EXPECT_EQ(obstacles.index({1, 1}) + obstacles.offset({0, -1}), obstacles.index({1, 0}));
+}
+
+TEST(PaddedObstacleMapTest, drillAndUndo) {
+  Game game("(0,0),(4,0),(4,3),(0,3)#(0,0)#(1,0),(3,0),(3,2),(1,2)#L(0,1)");
+  Wrapper* w = game.wrappers[0].get();
+  w->move(Action::UP); game.tick();
+  w->useBooster(Action::DRILL); game.tick();
+  w->move(Action::RIGHT); game.tick();
+  w->move(Action::RIGHT); game.tick();
+  EXPECT_EQ(PaddedObstacleMap::kFree, game.obstacle_map(1, 1));
+  expectSameObstacles(game.map2d, game.obstacle_map);
+  Game copied(game);
+  expectSameObstacles(copied.map2d, copied.obstacle_map);
+
+  game.undo();
+  game.undo();
+  expectSameObstacles(game.map2d, game.obstacle_map);
+}
+
+TEST(PaddedObstacleMapTest, reachableManipulators) {
+  constexpr int I = CellType::kObstacleBit;
+  Map2D map(7, 3, {
+    0, 0, 0, 0, I, 0, 0,
+    0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0,
+  });
+  PaddedObstacleMap obstacles(map);
+  const std::vector<Point> manipulators = {{1, 0}, {1, 1}, {1, -1}, {2, -1}, {-1, 0}, {3, 1}, {6, 0}, {-7, 0}};
+  for (int y = 0; y < map.H; ++y) {
+    for (int x = 0; x < map.W; ++x) {
+      EXPECT_EQ(absolutePositionOfReachableManipulators(map, {x, y}, manipulators),
+                absolutePositionOfReachableManipulators(obstacles, {x, y}, manipulators)) << x << "," << y;
+    }
+  }
+}
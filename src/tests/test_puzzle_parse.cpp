@@ -71,4 +71,105 @@ TEST(PuzzleTest, puzzleSolutionToString) {
   EXPECT_EQ(
     "(0,0),(4,0),(4,4),(0,4)#(1,1)##B(1,2);F(1,3);L(2,0);R(2,1);C(2,2);X(2,3)",
     sol.toString());
-}
\ No newline at end of file
+}
+
+namespace {
+
+// tSize = 10, 4 .. 8 corners, one booster of each kind but clones.
+Puzzle smallPuzzle() {
+  return parsePuzzleCondString("1,1,10,4,8,1,1,1,1,0,1#(1,1),(8,1)#(9,9)");
+}
+
+PuzzleSolution lShapedSolution() {
+  PuzzleSolution sol;
+  sol.wall = {{0, 0}, {10, 0}, {10, 5}, {5, 5}, {5, 10}, {0, 10}};
+  sol.wrapper = {0, 0};
+  sol.Bs = {{1, 2}};
+  sol.Fs = {{1, 3}};
+  sol.Ls = {{2, 0}};
+  sol.Rs = {{2, 1}};
+  sol.Xs = {{2, 3}};
+  return sol;
+}
+
+std::string reasonOf(const Puzzle& puzzle, const PuzzleSolution& sol) {
+  std::string reason;
+  return PuzzleValidator(puzzle).validate(sol, &reason) ? "valid" : reason;
+}
+
+} // namespace
+
+TEST(PuzzleValidatorTest, Valid) {
+  auto puzzle = smallPuzzle();
+  auto sol = lShapedSolution();
+  EXPECT_EQ("valid", reasonOf(puzzle, sol));
+  EXPECT_TRUE(puzzle.validateSolution(sol));
+
+  // collinear and duplicated points are not corners.
+  sol.wall = {{0, 0}, {3, 0}, {3, 0}, {10, 0}, {10, 5}, {5, 5}, {5, 10}, {0, 10}, {0, 4}};
+  EXPECT_EQ("valid", reasonOf(puzzle, sol));
+
+  // the validator is reusable.
+  PuzzleValidator validator(puzzle);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(validator.validate(lShapedSolution()));
+  }
+}
+
+TEST(PuzzleValidatorTest, Geometry) {
+  auto puzzle = smallPuzzle();
+  auto sol = lShapedSolution();
+  sol.wall = {{0, 0}, {11, 0}, {11, 5}, {5, 5}, {5, 10}, {0, 10}};
+  EXPECT_EQ("large W", reasonOf(puzzle, sol));
+  sol.wall = {{0, 0}, {10, 0}, {10, 5}, {5, 5}, {5, 8}, {0, 8}};
+  EXPECT_EQ("small H", reasonOf(puzzle, sol));
+  sol.wall = {{0, 0}, {10, 0}, {5, 10}, {0, 10}};
+  EXPECT_EQ("not axis-aligned edge", reasonOf(puzzle, sol));
+  sol.wall = {{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+  EXPECT_EQ("outside point is in", reasonOf(puzzle, sol));
+
+  puzzle.vMin = 8;
+  sol = lShapedSolution();
+  EXPECT_EQ("too few vertices", reasonOf(puzzle, sol));
+  puzzle.vMin = 4;
+  puzzle.vMax = 5;
+  EXPECT_EQ("too many vertices", reasonOf(puzzle, sol));
+}
+
+TEST(PuzzleValidatorTest, SimplePolygon) {
+  auto puzzle = smallPuzzle();
+  puzzle.vMax = 20;
+  auto sol = lShapedSolution();
+  // two rooms touching at (5, 5).
+  sol.wall = {{0, 0}, {10, 0}, {10, 5}, {5, 5}, {5, 10}, {10, 10}, {10, 5}, {5, 5}, {0, 5}};
+  EXPECT_NE("valid", reasonOf(puzzle, sol));
+  // crossing edges.
+  sol.wall = {{0, 0}, {10, 0}, {10, 10}, {6, 10}, {6, 4}, {2, 4}, {2, 6}, {8, 6}, {8, 10}, {0, 10}};
+  EXPECT_NE("valid", reasonOf(puzzle, sol));
+  // a slit. the edges (5, 3)-(5, 10) overlap.
+  sol.wall = {{0, 0}, {10, 0}, {10, 10}, {5, 10}, {5, 3}, {5, 10}, {0, 10}};
+  EXPECT_NE("valid", reasonOf(puzzle, sol));
+}
+
+TEST(PuzzleValidatorTest, Boosters) {
+  auto puzzle = smallPuzzle();
+  auto sol = lShapedSolution();
+  sol.Cs = {{3, 3}};
+  EXPECT_EQ("booster C size mismatch", reasonOf(puzzle, sol));
+  sol = lShapedSolution();
+  sol.Xs = {{1, 2}};
+  EXPECT_EQ("multiple boosters at the same location", reasonOf(puzzle, sol));
+  sol = lShapedSolution();
+  sol.Xs = {{7, 7}};
+  EXPECT_EQ("invalid booster pos", reasonOf(puzzle, sol));
+  sol = lShapedSolution();
+  sol.wrapper = {10, 0};
+  EXPECT_EQ("invalid wrapper pos", reasonOf(puzzle, sol));
+
+  // marks of boosters do not remain after a failure.
+  PuzzleValidator validator(puzzle);
+  sol = lShapedSolution();
+  sol.Xs = {{7, 7}};
+  EXPECT_FALSE(validator.validate(sol));
+  EXPECT_TRUE(validator.validate(lShapedSolution()));
+}
@@ -0,0 +1,94 @@
+#include "../puzzle_search.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// 2x2 room. the booster is at one of 3 cells by the seed, and the first 2 seeds after 100 are invalid.
+PuzzleSolution seededPuzzleSolver(PuzzleSolverParam param, Puzzle puzzle) {
+  PuzzleSolution solution;
+  if (param.seed < 102) return solution;
+  const Point cells[] = {{1, 0}, {1, 1}, {0, 1}};
+  solution.wall = {{0, 0}, {2, 0}, {2, 2}, {0, 2}};
+  solution.wrapper = {0, 0};
+  solution.Bs = {cells[param.seed % 3]};
+  return solution;
+}
+
+// waits (3y + x) of the booster, then moves up to finish.
+std::string boosterWaitSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
+  int wait = 0;
+  for (int y = 0; y < game->map2d.H; ++y)
+    for (int x = 0; x < game->map2d.W; ++x)
+      if (game->map2d(x, y) & CellType::kBoosterManipulatorBit) wait = 3 * y + x;
+  for (int i = 0; i < wait; ++i) {
+    game->wrappers[0]->nop();
+    game->tick();
+  }
+  game->wrappers[0]->move(Action::UP);
+  game->tick();
+  return game->getCommand();
+}
+
+REGISTER_PUZZLE_SOLVER("puzzle_search_test_seeded", seededPuzzleSolver);
+REGISTER_SOLVER("puzzle_search_test_booster_wait", boosterWaitSolver);
+
+Puzzle testPuzzle() {
+  Puzzle puzzle;
+  puzzle.tSize = 2;
+  puzzle.vMin = 4;
+  puzzle.vMax = 4;
+  puzzle.mNum = 1;
+  return puzzle;
+}
+
+} // namespace
+
+TEST(PuzzleSearchTest, FirstValid) {
+  PuzzleSearchParam param;
+  param.solvers = {"puzzle_search_test_seeded"};
+  param.seed = 100;
+  param.num_candidates = 5;
+  param.num_threads = 2;
+  param.score_engine = "";
+  auto result = searchPuzzle(testPuzzle(), param);
+  EXPECT_TRUE(result.valid);
+  EXPECT_EQ(102, result.seed);
+  EXPECT_EQ(-1, result.score);
+  EXPECT_EQ(5, result.num_candidates);
+  EXPECT_EQ(3, result.num_valid);
+  EXPECT_TRUE(testPuzzle().validateSolution(result.solution));
+}
+
+TEST(PuzzleSearchTest, Hardest) {
+  PuzzleSearchParam param;
+  param.solvers = {"puzzle_search_test_seeded"};
+  param.seed = 102;
+  param.num_candidates = 3;
+  param.score_engine = "puzzle_search_test_booster_wait";
+  // seeds 102, 103, 104 put the booster at (1, 0), (1, 1) and (0, 1).
+  EXPECT_EQ(2, scorePuzzleSolution(seededPuzzleSolver({0, 102}, testPuzzle()), param.score_engine));
+  EXPECT_EQ(5, scorePuzzleSolution(seededPuzzleSolver({0, 103}, testPuzzle()), param.score_engine));
+  auto result = searchPuzzle(testPuzzle(), param);
+  EXPECT_TRUE(result.valid);
+  EXPECT_EQ(103, result.seed);
+  EXPECT_EQ(5, result.score);
+  EXPECT_EQ("puzzle_search_test_seeded", result.solver);
+}
+
+TEST(PuzzleSearchTest, UnknownSolver) {
+  PuzzleSearchParam param;
+  param.solvers = {"no_such_puzzle_solver"};
+  EXPECT_FALSE(searchPuzzle(testPuzzle(), param).valid);
+}
+
+TEST(PuzzleSearchTest, UnknownScoreEngine) {
+  PuzzleSearchParam param;
+  param.solvers = {"puzzle_search_test_seeded"};
+  param.seed = 102;
+  param.score_engine = "no_such_engine";
+  EXPECT_EQ(-1, scorePuzzleSolution(seededPuzzleSolver({0, 102}, testPuzzle()), param.score_engine));
+  auto result = searchPuzzle(testPuzzle(), param);
+  EXPECT_FALSE(result.valid);
+  EXPECT_EQ(0, result.num_candidates);
+}
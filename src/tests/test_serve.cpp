@@ -0,0 +1,101 @@
+#include "../serve.h"
+#include "../solver_registry.h"
+
+#include <gtest/gtest.h>
+#include <set>
+#include <sstream>
+
+namespace {
+
+std::string moveRightSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
+  while (!game->isEnd()) {
+    game->wrappers[0]->move(Action::RIGHT);
+    game->tick();
+    if (iter_callback && !iter_callback(game)) break;
+  }
+  return game->getCommand();
+}
+
+REGISTER_SOLVER("serve_test_move_right", moveRightSolver);
+
+} // namespace
+
+TEST(ServeTest, parseServeJob) {
+  ServeJob job;
+  std::string error;
+  ASSERT_TRUE(parseServeJob(R"({"id":"a\"1", "desc":"prob-001.desc", "engine":"bfs2", "buy":"BC", "time_limit":1.5, "restarts":4, "seed":7, "deadline":null})", job, error)) << error;
+  EXPECT_EQ("a\"1", job.id);
+  EXPECT_EQ("prob-001.desc", job.desc_path);
+  EXPECT_EQ("bfs2", job.engine);
+  EXPECT_EQ("BC", job.buy);
+  EXPECT_DOUBLE_EQ(1.5, job.time_limit_s);
+  EXPECT_EQ(0, job.deadline);
+  EXPECT_EQ(4, job.num_restarts);
+  EXPECT_EQ(7u, job.seed);
+
+  auto parse = [](const std::string& line) {
+    ServeJob job;
+    std::string error;
+    return parseServeJob(line, job, error);
+  };
+  EXPECT_FALSE(parse(R"({"id":"1", "engine":"bfs2"})"));
+  EXPECT_FALSE(parse(R"({"id":"1", "desc":"a", "desc_str":"b", "engine":"bfs2"})"));
+  EXPECT_FALSE(parse(R"({"id":"1", "desc":"a", "engine":"bfs2", "color":"red"})"));
+  EXPECT_FALSE(parse(R"({"id":"1", "desc":"a" "engine":"bfs2"})"));
+  EXPECT_FALSE(parse(R"({"id":"1", "desc":"a", "engine":"bfs2", "seed":x})"));
+}
+
+TEST(ServeTest, serveStream) {
+  std::istringstream in(
+    R"({"id":"1", "desc_str":"(0,0),(6,0),(6,1),(0,1)#(0,0)##", "engine":"serve_test_move_right"})" "\n"
+    "\n"
+    R"({"id":"2", "desc_str":"(0,0),(6,0),(6,1),(0,1)#(0,0)##", "engine":"no_such_engine"})" "\n"
+    R"({"id":"3", "desc":"no/such/file.desc", "engine":"serve_test_move_right"})" "\n"
+    R"(broken)" "\n");
+  std::ostringstream out;
+  serveStream(in, out, 2);
+
+  // results come in the order of completion.
+  std::istringstream results(out.str());
+  std::set<std::string> lines;
+  for (std::string line; std::getline(results, line);) {
+    lines.insert(line.substr(0, line.find(",\"elapsed\"")));
+  }
+  EXPECT_EQ(4, lines.size());
+  EXPECT_EQ(1, lines.count(R"({"id":"1","ok":true,"time_unit":4,"solution":"DDDD")"));
+  EXPECT_EQ(1, lines.count(R"({"id":"2","ok":false,"error":"unknown engine no_such_engine"})"));
+  EXPECT_EQ(1, lines.count(R"({"id":"3","ok":false,"error":"can not read no/such/file.desc"})"));
+  EXPECT_EQ(1, lines.count(R"({"id":"","ok":false,"error":"'{' is expected at 0"})"));
+}
+
+TEST(ServeTest, brokenInputs) {
+  ServeJob job;
+  std::string error;
+  ASSERT_TRUE(parseServeJob(R"({"id":"\u0041\u006a", "desc":"a", "engine":"bfs2"})", job, error)) << error;
+  EXPECT_EQ("Aj", job.id);
+  EXPECT_FALSE(parseServeJob(R"({"id":"\uZZZZ", "desc":"a", "engine":"bfs2"})", job, error));
+  EXPECT_FALSE(parseServeJob(R"({"id":"\u00", "desc":"a", "engine":"bfs2"})", job, error));
+  EXPECT_FALSE(parseServeJob(R"({"id":"1", "desc":"a", "engine":"bfs2", "buy":"BZ"})", job, error));
+
+  std::istringstream in(
+    R"({"id":"1", "desc_str":"garbage", "engine":"serve_test_move_right"})" "\n"
+    R"({"id":"2", "desc_str":"(0,0),(6,0),(6,1),(0,1)#(9,0)##", "engine":"serve_test_move_right"})" "\n");
+  std::ostringstream out;
+  serveStream(in, out, 1);
+  EXPECT_NE(std::string::npos, out.str().find(R"({"id":"1","ok":false,"error":"broken desc: broken map at 0"})"));
+  EXPECT_NE(std::string::npos, out.str().find(R"({"id":"2","ok":false,"error":"broken desc: wrappy out of the map"})"));
+}
+
+TEST(ServeTest, workspaceKeepsRecentGames) {
+  ServeWorkspace workspace;
+  for (int i = 0; i < ServeWorkspace::kMaxGames; ++i) {
+    workspace.add(std::to_string(i), std::unique_ptr<Game>(new Game("(0,0),(6,0),(6,1),(0,1)#(0,0)##")));
+  }
+  // "0" becomes the most recently used, so "1" is dropped by the next one.
+  EXPECT_NE(nullptr, workspace.find("0"));
+  workspace.add("new", std::unique_ptr<Game>(new Game("(0,0),(6,0),(6,1),(0,1)#(0,0)##")));
+  EXPECT_EQ(ServeWorkspace::kMaxGames, workspace.games.size());
+  EXPECT_EQ(nullptr, workspace.find("1"));
+  EXPECT_NE(nullptr, workspace.find("0"));
+  EXPECT_NE(nullptr, workspace.find("new"));
+}
@@ -0,0 +1,62 @@
+#include "../solution.h"
+#include "../solution_optimizer.h"
+
+#include <gtest/gtest.h>
+
+TEST(SolutionTest, parseAndToString) {
+  const std::string str = "WDB(1,-2)QZ#FT(3,4)C#";
+  SolutionCommands commands = parseSolutionString(str);
+  ASSERT_EQ(3, commands.size());
+  EXPECT_EQ((std::vector<std::string>{"W", "D", "B(1,-2)", "Q", "Z"}), commands[0]);
+  EXPECT_EQ((std::vector<std::string>{"F", "T(3,4)", "C"}), commands[1]);
+  EXPECT_TRUE(commands[2].empty());
+  EXPECT_EQ(str, solutionToString(commands));
+}
+
+TEST(SolutionTest, replay) {
+  const std::vector<std::string> map = {
+    "@...",
+  };
+  {
+    Game game(map);
+    EXPECT_TRUE(replaySolution(&game, parseSolutionString("DDD")));
+    EXPECT_TRUE(game.isEnd());
+    EXPECT_EQ(3, game.time);
+  }
+  {
+    Game game(map);
+    EXPECT_TRUE(replaySolution(&game, parseSolutionString("D")));
+    EXPECT_FALSE(game.isEnd());
+  }
+  {
+    // out of the map
+    Game game(map);
+    EXPECT_FALSE(replaySolution(&game, parseSolutionString("A")));
+  }
+  {
+    // no booster
+    Game game(map);
+    EXPECT_FALSE(replaySolution(&game, parseSolutionString("B(1,2)")));
+  }
+  {
+    // no wrapper to execute the second commands
+    Game game(map);
+    EXPECT_FALSE(replaySolution(&game, parseSolutionString("DDD#Z")));
+  }
+}
+
+TEST(SolutionTest, optimizeRemovesDetour) {
+  Game game(std::vector<std::string>{
+    "@...",
+  });
+  OptimizerParam param;
+  param.num_threads = 2;
+  param.time_limit_s = 10;
+  const SolutionCommands input = parseSolutionString("DADQEZDDZ");
+  const SolutionCommands optimized = optimizeSolution(game, input, param);
+  EXPECT_EQ("DDD", solutionToString(optimized));
+
+  Game replayed(game);
+  EXPECT_TRUE(replaySolution(&replayed, optimized));
+  EXPECT_TRUE(replayed.isEnd());
+}
@@ -61,4 +61,105 @@ TEST(SolverHelperTest, findFCRoute) {
     std::cout << res->C_pos << std::endl;
     std::cout << res->time_cost << std::endl;
   }
-}
\ No newline at end of file
+}
+TEST(SolverHelperTest, findOrientationAwareSweep) {
+  // 3-wide vertical corridor. facing up covers a whole row by each move.
+  Game game("(0,0),(3,0),(3,10),(0,10)#(1,0)##");
+  Wrapper* w = game.wrappers[0].get();
+  auto plan = findOrientationAwareSweep(game.map2d, w->pos, w->direction, w->manipulators, 8);
+  EXPECT_EQ(8, plan.commands.size());
+  EXPECT_NE(std::string::npos, plan.commands.find_first_of("EQ"));
+
+  // the gain is exact when the plan is executed.
+  const int num_unwrapped = game.map2d.num_unwrapped;
+  for (char c : plan.commands) {
+    if (c == Action::CW || c == Action::CCW) {
+      w->turn(c);
+    } else {
+      w->move(c);
+    }
+    game.tick();
+  }
+  EXPECT_EQ(plan.gain, num_unwrapped - game.map2d.num_unwrapped);
+}
+
+TEST(SolverHelperTest, solverRandom) {
+  // the same as rand() of glibc.
+  SolverRandom random(3333);
+  EXPECT_EQ(SolverRandom::result_type(1804289383), SolverRandom(1)());
+  EXPECT_EQ(SolverRandom(1)(), SolverRandom(0)());
+  std::srand(3333);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(SolverRandom::result_type(std::rand()), random());
+  }
+}
+
+TEST(SolverHelperTest, restartSolver) {
+  Game game(std::vector<std::string>{
+    "@.....",
+  });
+  SolverParam param;
+  param.num_threads = 2;
+  std::vector<unsigned> first_randoms(3);
+  std::vector<int> last_times(3);
+  // the run 1 waits once, and the others wait 3 times before going right.
+  auto sub = [&](SolverParam p, Game* g, SolverIterCallback callback, int iter) {
+    EXPECT_EQ(3333u + iter, p.seed);
+    first_randoms[iter] = solverRandom()();
+    for (int waits = (iter == 1 ? 1 : 3); !g->isEnd(); --waits) {
+      if (waits > 0) {
+        g->wrappers[0]->nop();
+      } else {
+        g->wrappers[0]->move(Action::RIGHT);
+      }
+      g->tick();
+      last_times[iter] = g->time;
+      if (!callback(g)) break;
+    }
+    return g->getCommand();
+  };
+  restartSolver(param, &game, nullptr, 3, sub);
+  EXPECT_EQ(5, game.time);
+  EXPECT_EQ("ZDDDD", game.getCommand());
+  for (int iter = 0; iter < 3; ++iter) {
+    EXPECT_EQ(SolverRandom(3333 + iter)(), first_randoms[iter]);
+  }
+  // the run 2 starts after the run 1 finished, and it is aborted when it can not be better.
+  EXPECT_EQ(5, last_times[2]);
+}
+
+TEST(SolverHelperTest, getTrajClonesInSourceOrder) {
+  Game game(std::vector<std::string>{
+    "C.C.C..#...",
+    "...#...#.C.",
+    "@....CC....",
+    "..#....#..X",
+  });
+  // the second one goes through the C taken by the first one.
+  std::vector<map_parse::SearchSource> sources = {
+    {{4, 1}, 0},
+    {{4, 1}, 1},
+    {{2, 2}, 2},
+    {{1, 1}, 3, true},
+    {{8, 3}, 4},
+    {{0, 0}, 5, false, true},
+    {{10, 2}, 6},
+  };
+  auto trajs = getTrajClones(game, sources, std::vector<std::vector<Trajectory>>(sources.size()), DISTANCE_INF);
+  ASSERT_EQ(sources.size(), trajs.size());
+
+  // the same as searching one by one with the taken C hidden under wrapped cells.
+  Game edited(game);
+  for (int k = 0; k < sources.size(); ++k) {
+    const auto& s = sources[k];
+    auto expected = map_parse::findNearestByBit(edited, s.pos, DISTANCE_INF, CellType::kBoosterCloningBit, s.dstart, s.astart);
+    ASSERT_EQ(expected.size(), trajs[k].size()) << k;
+    for (int i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i].pos, trajs[k][i].pos) << k;
+      EXPECT_EQ(expected[i].distance, trajs[k][i].distance) << k;
+    }
+    if (!expected.empty()) edited.map2d(expected.back().pos) = CellType::kWrappedBit;
+  }
+  // 6 C for 7 sources.
+  EXPECT_TRUE(trajs.back().empty());
+}
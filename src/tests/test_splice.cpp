@@ -0,0 +1,54 @@
+#include "../splice.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// move the first wrapper to the right until all cells are wrapped.
+std::string moveRightSolver(SolverParam param, Game* game, SolverIterCallback iter_callback) {
+  while (!game->isEnd()) {
+    for (auto& w : game->wrappers) {
+      if (w->index == 0) {
+        w->move(Action::RIGHT);
+      } else {
+        w->nop();
+      }
+    }
+    game->tick();
+    if (iter_callback && !iter_callback(game)) break;
+  }
+  return game->getCommand();
+}
+
+REGISTER_SOLVER("splice_test_move_right", moveRightSolver);
+
+Game makeGame() {
+  Game game(std::vector<std::string>{
+    "@X....",
+  });
+  game.num_boosters[BoosterType::CLONING] = 1;
+  return game;
+}
+
+} // namespace
+
+TEST(SpliceTest, checkpoints) {
+  Game game = makeGame();
+  const SolutionCommands commands = parseSolutionString("DCDDZD#");
+  // the clone is spawned at time 2.
+  EXPECT_EQ(std::vector<int>({2}), findSpliceCheckpoints(game, commands, {}));
+  // 0 is the start. (engines solve from scratch)
+  EXPECT_EQ(std::vector<int>({0, 2, 4}), findSpliceCheckpoints(game, commands, {0.0, 0.4, 0.7}));
+}
+
+TEST(SpliceTest, splice) {
+  Game game = makeGame();
+  SpliceParam param;
+  param.engines = {"splice_test_move_right", "no_such_engine"};
+  param.num_threads = 2;
+  SpliceResult result = spliceSolutions(game, {{"a", parseSolutionString("DCDDZD#")}}, param);
+  ASSERT_TRUE(result.valid);
+  EXPECT_EQ(5, result.time);
+  EXPECT_EQ("a@2+splice_test_move_right", result.description);
+  EXPECT_EQ("DCDDD#ZZZ", result.command);
+}
@@ -0,0 +1,43 @@
+#include "../transposition_table.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TranspositionTableTest, visit) {
+  TranspositionTable table;
+  EXPECT_TRUE(table.visit(1, 10));
+  EXPECT_FALSE(table.visit(1, 10));
+  EXPECT_FALSE(table.visit(1, 12));
+  EXPECT_TRUE(table.visit(1, 8)); // reached earlier.
+  int time = 0;
+  ASSERT_TRUE(table.find(1, &time));
+  EXPECT_EQ(8, time);
+  EXPECT_FALSE(table.find(2, &time));
+  EXPECT_TRUE(table.visit(~0ull, 3));
+  EXPECT_EQ(2, table.size());
+  table.clear();
+  EXPECT_EQ(0, table.size());
+}
+
+TEST(TranspositionTableTest, concurrentVisits) {
+  TranspositionTable table;
+  constexpr int kThreads = 4;
+  constexpr int kKeys = 10000;
+  std::vector<int> num_new(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kKeys; ++i) {
+        // spread keys over the shards.
+        num_new[t] += table.visit(uint64_t(i) * 0x9e3779b97f4a7c15ull, 100);
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+  int total = 0;
+  for (int n : num_new) total += n;
+  EXPECT_EQ(kKeys, total); // every key is new for exactly one thread.
+  EXPECT_EQ(kKeys, table.size());
+}
@@ -0,0 +1,91 @@
+#include "../unwrapped_pyramid.h"
+#include "../trajectory.h"
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+TEST(UnwrappedPyramidTest, countAndUpdate) {
+  constexpr int I = CellType::kObstacleBit;
+  constexpr int V = CellType::kWrappedBit;
+  Map2D map(5, 3, {
+    0, V, I, 0, 0,
+    V, V, I, V, 0,
+    0, I, V, V, V,
+  });
+  UnwrappedPyramid pyramid(map);
+  const int num_unwrapped = countCellsByMask(map, I | V, 0);
+  EXPECT_EQ(5, num_unwrapped);
+  EXPECT_EQ(num_unwrapped, pyramid.count());
+  EXPECT_EQ(4, pyramid.numLevels()); // 5x3, 3x2, 2x1, 1x1
+  EXPECT_TRUE(pyramid.isUnwrapped({0, 0}));
+  EXPECT_FALSE(pyramid.isUnwrapped({2, 0}));
+
+  pyramid.set({0, 0}, false);
+  pyramid.set({0, 0}, false); // idempotent
+  EXPECT_EQ(num_unwrapped - 1, pyramid.count());
+  pyramid.set({0, 0}, true);
+  EXPECT_EQ(num_unwrapped, pyramid.count());
+}
+
+TEST(UnwrappedPyramidTest, findNearest) {
+  const int W = 37, H = 23;
+  const int kNone = W + H;
+  std::srand(1);
+  Map2D map(W, H, CellType::kWrappedBit);
+  UnwrappedPyramid pyramid(map);
+  Point nearest;
+  int distance;
+  EXPECT_FALSE(pyramid.findNearest({0, 0}, nearest, distance));
+
+  for (int iter = 0; iter < 200; ++iter) {
+    Point p(std::rand() % W, std::rand() % H);
+    pyramid.set(p, iter % 3 != 0);
+    map(p) = iter % 3 != 0 ? 0 : CellType::kWrappedBit;
+
+    Point from(std::rand() % W, std::rand() % H);
+    int expected = kNone;
+    for (auto q : enumerateCellsByMask(map, CellType::kWrappedBit, 0)) {
+      expected = std::min(expected, (q - from).lengthManhattan());
+    }
+    EXPECT_EQ(std::min(expected, 8), pyramid.localDistance(from, 8));
+    if (expected == kNone) {
+      EXPECT_FALSE(pyramid.findNearest(from, nearest, distance));
+      continue;
+    }
+    ASSERT_TRUE(pyramid.findNearest(from, nearest, distance));
+    EXPECT_EQ(expected, distance);
+    EXPECT_EQ(expected, (nearest - from).lengthManhattan());
+    EXPECT_EQ(0, map(nearest));
+  }
+}
+
+TEST(UnwrappedPyramidTest, tileBound) {
+  const int W = 37, H = 23;
+  std::srand(2);
+  Map2D map(W, H, CellType::kWrappedBit);
+  UnwrappedPyramid pyramid(map);
+  EXPECT_EQ(DISTANCE_INF, pyramid.tileBound(4)({0, 0}));
+
+  for (int iter = 0; iter < 200; ++iter) {
+    Point p(std::rand() % W, std::rand() % H);
+    pyramid.set(p, iter % 3 != 0);
+    map(p) = iter % 3 != 0 ? 0 : CellType::kWrappedBit;
+
+    const auto bound = pyramid.tileBound(4);
+    const int tile = 1 << bound.level();
+    for (int k = 0; k < 10; ++k) {
+      Point from(std::rand() % W, std::rand() % H);
+      int expected;
+      Point nearest;
+      if (!pyramid.findNearest(from, nearest, expected)) expected = DISTANCE_INF;
+      const int b = bound(from);
+      if (expected == DISTANCE_INF) {
+        EXPECT_EQ(DISTANCE_INF, b);
+        continue;
+      }
+      // a lower bound, within the size of a tile.
+      EXPECT_LE(b, expected);
+      EXPECT_GE(b, expected - 2 * (tile - 1));
+    }
+  }
+}
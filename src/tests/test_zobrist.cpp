@@ -0,0 +1,84 @@
+#include "../zobrist.h"
+#include "../game.h"
+
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+TEST(ZobristTest, incrementalHashFollowsActionsAndUndo) {
+  Game game("(0,0),(10,0),(10,10),(0,10)#(0,0)#(4,2),(6,2),(6,7),(4,7)#B(0,1);L(0,2);C(0,3);X(0,4);R(1,4)");
+  std::vector<uint64_t> history = {game.hash()};
+  EXPECT_EQ(game.computeHash(), game.hash());
+  auto step = [&]() {
+    game.tick();
+    EXPECT_EQ(game.computeHash(), game.hash()) << game.time;
+    history.push_back(game.hash());
+  };
+
+  // boosters are picked at the beginning of the next action. (nop before using them)
+  Wrapper* wrapper = game.wrappers[0].get();
+  wrapper->move(Action::UP); step();
+  wrapper->nop(); step();
+  wrapper->addManipulator({1, 2}); step();
+  wrapper->move(Action::UP); step();
+  wrapper->nop(); step();
+  wrapper->useBooster(Action::DRILL); step();
+  wrapper->move(Action::UP); step();
+  wrapper->move(Action::UP); step();
+  wrapper->cloneWrapper(); step();
+  wrapper->move(Action::RIGHT);
+  game.wrappers[1]->turn(Action::CW);
+  step();
+  wrapper->nop();
+  game.wrappers[1]->move(Action::RIGHT);
+  step();
+  wrapper->useBooster(Action::BEACON);
+  game.wrappers[1]->move(Action::RIGHT);
+  step();
+  wrapper->move(Action::RIGHT);
+  game.wrappers[1]->move(Action::DOWN);
+  step();
+  for (int i = 0; i < history.size(); ++i) {
+    for (int j = 0; j < i; ++j) EXPECT_NE(history[i], history[j]) << i << " " << j;
+  }
+
+  // copies and checkpoints have the same hash.
+  EXPECT_EQ(game.hash(), Game(game).hash());
+  std::stringstream ss;
+  game.save(ss);
+  auto loaded = Game::load(ss);
+  ASSERT_TRUE(bool(loaded));
+  EXPECT_EQ(game.hash(), loaded->hash());
+
+  // undo removes a wrapper with no actions left. (the clone at time 9, and the first wrapper at time 0)
+  while (game.time > 1) {
+    game.undo();
+    EXPECT_EQ(game.computeHash(), game.hash()) << game.time;
+    if (game.time != 9) {
+      EXPECT_EQ(history[game.time], game.hash()) << game.time;
+    }
+  }
+}
+
+TEST(ZobristTest, sameStateAtDifferentTimes) {
+  Game game("(0,0),(3,0),(3,3),(0,3)#(0,0)##");
+  Wrapper* wrapper = game.wrappers[0].get();
+  wrapper->move(Action::UP); game.tick();
+  const uint64_t h = game.hash();
+  wrapper->turn(Action::CW); game.tick();
+  EXPECT_NE(h, game.hash());
+  wrapper->turn(Action::CCW); game.tick();
+  EXPECT_EQ(h, game.hash());
+  wrapper->nop(); game.tick();
+  EXPECT_EQ(h, game.hash());
+}
+
+TEST(ZobristTest, manipulatorsAreASet) {
+  Game game("(0,0),(5,0),(5,5),(0,5)#(0,0)##");
+  Wrapper& w = *game.wrappers[0];
+  const uint64_t h = zobrist::wrapperKey(w);
+  std::swap(w.manipulators[0], w.manipulators[2]);
+  EXPECT_EQ(h, zobrist::wrapperKey(w));
+  w.manipulators.push_back({1, 2});
+  EXPECT_NE(h, zobrist::wrapperKey(w));
+}
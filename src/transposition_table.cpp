@@ -0,0 +1,38 @@
+#include "transposition_table.h"
+
+constexpr int TranspositionTable::kShardBits;
+
+bool TranspositionTable::visit(uint64_t hash, int time) {
+  Shard& s = shard(hash);
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto inserted = s.times.emplace(hash, time);
+  if (inserted.second) return true;
+  if (time >= inserted.first->second) return false;
+  inserted.first->second = time;
+  return true;
+}
+
+bool TranspositionTable::find(uint64_t hash, int* time) const {
+  const Shard& s = shard(hash);
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto it = s.times.find(hash);
+  if (it == s.times.end()) return false;
+  if (time) *time = it->second;
+  return true;
+}
+
+size_t TranspositionTable::size() const {
+  size_t n = 0;
+  for (auto& s : shards) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    n += s.times.size();
+  }
+  return n;
+}
+
+void TranspositionTable::clear() {
+  for (auto& s : shards) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.times.clear();
+  }
+}
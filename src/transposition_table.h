@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+// visited states of a search, shared between threads. (key: Game::hash())
+// keys are split into shards with their own locks by the top bits, so threads rarely wait for each other.
+class TranspositionTable {
+public:
+  // true if the state is new, or it is reached earlier than before. then the time is recorded.
+  // a search continues from the state only if this returns true.
+  bool visit(uint64_t hash, int time);
+  // the earliest recorded time of the state. false if it is not recorded.
+  bool find(uint64_t hash, int* time) const;
+  size_t size() const;
+  void clear();
+
+private:
+  static constexpr int kShardBits = 6;
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, int> times;
+  };
+  Shard& shard(uint64_t hash) { return shards[hash >> (64 - kShardBits)]; }
+  const Shard& shard(uint64_t hash) const { return shards[hash >> (64 - kShardBits)]; }
+
+  std::array<Shard, 1 << kShardBits> shards;
+};
@@ -0,0 +1,143 @@
+#include "unwrapped_pyramid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <queue>
+#include <tuple>
+
+#include "trajectory.h"
+
+void UnwrappedPyramid::reset(const Map2D& map) {
+  static constexpr int kUnwrappedMask = CellType::kObstacleBit | CellType::kWrappedBit;
+  W = map.W;
+  H = map.H;
+  levels.clear();
+  if (W * H == 0) return;
+  levels.emplace_back(W * H, 0);
+  for (int y = 0; y < H; ++y) {
+    for (int x = 0; x < W; ++x) {
+      levels[0][y * W + x] = (map(x, y) & kUnwrappedMask) == 0;
+    }
+  }
+  for (int l = 1; tileW(l - 1) > 1 || tileH(l - 1) > 1; ++l) {
+    const int w = tileW(l), h = tileH(l);
+    const int pw = tileW(l - 1), ph = tileH(l - 1);
+    std::vector<int> level(w * h, 0);
+    for (int y = 0; y < ph; ++y) {
+      for (int x = 0; x < pw; ++x) {
+        level[(y >> 1) * w + (x >> 1)] += levels[l - 1][y * pw + x];
+      }
+    }
+    levels.push_back(std::move(level));
+  }
+}
+
+void UnwrappedPyramid::set(Point p, bool unwrapped) {
+  assert (0 <= p.x && p.x < W && 0 <= p.y && p.y < H);
+  int& cell = levels[0][p.y * W + p.x];
+  if (cell == int(unwrapped)) return;
+  const int delta = unwrapped ? 1 : -1;
+  cell += delta;
+  for (int l = 1; l < levels.size(); ++l) {
+    levels[l][(p.y >> l) * tileW(l) + (p.x >> l)] += delta;
+  }
+}
+
+bool UnwrappedPyramid::findNearest(Point from, Point& nearest, int& distance) const {
+  if (count() == 0) return false;
+
+  // Manhattan distance from `from` to the tile.
+  auto tileDistance = [&](int level, int tx, int ty) {
+    const int x0 = tx << level, x1 = std::min(W, (tx + 1) << level) - 1;
+    const int y0 = ty << level, y1 = std::min(H, (ty + 1) << level) - 1;
+    const int dx = std::max({0, x0 - from.x, from.x - x1});
+    const int dy = std::max({0, y0 - from.y, from.y - y1});
+    return dx + dy;
+  };
+
+  // best-first descent. (distance, level, tx, ty). finer tiles first on ties.
+  using Tile = std::tuple<int, int, int, int>;
+  std::priority_queue<Tile, std::vector<Tile>, std::greater<Tile>> que;
+  const int top = levels.size() - 1;
+  que.emplace(tileDistance(top, 0, 0), top, 0, 0);
+  while (!que.empty()) {
+    int d, level, tx, ty;
+    std::tie(d, level, tx, ty) = que.top();
+    que.pop();
+    if (level == 0) {
+      nearest = {tx, ty};
+      distance = d;
+      return true;
+    }
+    const int cl = level - 1;
+    for (int cy = 2 * ty; cy <= 2 * ty + 1 && cy < tileH(cl); ++cy) {
+      for (int cx = 2 * tx; cx <= 2 * tx + 1 && cx < tileW(cl); ++cx) {
+        if (tileCount(cl, cx, cy) > 0) {
+          que.emplace(tileDistance(cl, cx, cy), cl, cx, cy);
+        }
+      }
+    }
+  }
+  assert (false); // count() > 0 but no cell found.
+  return false;
+}
+
+int UnwrappedPyramid::lowerBoundDistance(Point from) const {
+  Point nearest;
+  int distance;
+  if (!findNearest(from, nearest, distance)) return DISTANCE_INF;
+  return distance;
+}
+
+int UnwrappedPyramid::localDistance(Point from, int max_distance) const {
+  auto unwrapped = [&](int x, int y) {
+    return 0 <= x && x < W && 0 <= y && y < H && levels[0][y * W + x] != 0;
+  };
+  for (int d = 0; d < max_distance; ++d) {
+    for (int dx = -d; dx <= d; ++dx) {
+      const int dy = d - std::abs(dx);
+      if (unwrapped(from.x + dx, from.y + dy) || unwrapped(from.x + dx, from.y - dy)) return d;
+    }
+  }
+  return max_distance;
+}
+
+UnwrappedPyramid::TileBound UnwrappedPyramid::tileBound(int max_tiles) const {
+  TileBound bound;
+  if (count() == 0) return bound;
+  // descend from the top while the non-empty tiles of the next level are few enough.
+  int level = levels.size() - 1;
+  std::vector<Point> tiles = {Point(0, 0)};
+  std::vector<Point> children;
+  while (level > 0) {
+    children.clear();
+    const int cl = level - 1;
+    for (auto t : tiles) {
+      for (int cy = 2 * t.y; cy <= 2 * t.y + 1 && cy < tileH(cl); ++cy) {
+        for (int cx = 2 * t.x; cx <= 2 * t.x + 1 && cx < tileW(cl); ++cx) {
+          if (tileCount(cl, cx, cy) > 0) children.emplace_back(cx, cy);
+        }
+      }
+    }
+    if (children.size() > max_tiles) break;
+    tiles.swap(children);
+    level = cl;
+  }
+  bound.level_ = level;
+  for (auto t : tiles) {
+    bound.tiles.push_back({t.x << level, t.y << level,
+                           std::min(W, (t.x + 1) << level) - 1, std::min(H, (t.y + 1) << level) - 1});
+  }
+  return bound;
+}
+
+int UnwrappedPyramid::TileBound::operator()(Point from) const {
+  int distance = DISTANCE_INF;
+  for (auto& r : tiles) {
+    const int dx = std::max({0, r.x0 - from.x, from.x - r.x1});
+    const int dy = std::max({0, r.y0 - from.y, from.y - r.y1});
+    distance = std::min(distance, dx + dy);
+  }
+  return distance;
+}
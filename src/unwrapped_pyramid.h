@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "base.h"
+#include "map2d.h"
+
+// summary pyramid of unwrapped cells.
+// level 0 holds a flag for each cell, and level l holds the number of unwrapped cells
+// in each 2^l x 2^l tile. the top level is a single tile covering the whole map.
+// Game keeps it in sync in paint() and Wrapper::undoAction().
+class UnwrappedPyramid {
+public:
+  UnwrappedPyramid() = default;
+  explicit UnwrappedPyramid(const Map2D& map) { reset(map); }
+
+  // rebuild all levels from map. (cells with neither wrapped nor obstacle bit are unwrapped)
+  void reset(const Map2D& map);
+
+  // update a cell. it is idempotent.
+  void set(Point p, bool unwrapped);
+
+  bool isUnwrapped(Point p) const { return levels[0][p.y * W + p.x] != 0; }
+  int count() const { return levels.empty() ? 0 : levels.back()[0]; }
+  int numLevels() const { return levels.size(); }
+  // # of unwrapped cells in the tile (tx, ty) of the level.
+  int tileCount(int level, int tx, int ty) const { return levels[level][ty * tileW(level) + tx]; }
+
+  // the unwrapped cell nearest to `from` in Manhattan distance, ignoring obstacles.
+  // it is a lower bound of the path length. returns false if no unwrapped cell is left.
+  bool findNearest(Point from, Point& nearest, int& distance) const;
+  // distance part of findNearest(). DISTANCE_INF if none.
+  int lowerBoundDistance(Point from) const;
+  // the same distance if it is less than max_distance, or max_distance otherwise.
+  // it scans the cells around `from` without allocation, so it is cheaper than findNearest() for small max_distance.
+  int localDistance(Point from, int max_distance) const;
+
+  // a cheaper lower bound for many queries: the distance to the nearest non-empty tile of one level.
+  // the level is the finest one with at most max_tiles non-empty tiles. it is a snapshot; build it once per search.
+  class TileBound {
+  public:
+    int operator()(Point from) const; // DISTANCE_INF if no unwrapped cell is left.
+    int level() const { return level_; }
+  private:
+    friend class UnwrappedPyramid;
+    struct Rect { int x0, y0, x1, y1; }; // inclusive
+    std::vector<Rect> tiles;
+    int level_ = 0;
+  };
+  TileBound tileBound(int max_tiles) const;
+
+private:
+  int tileW(int level) const { return ((W - 1) >> level) + 1; }
+  int tileH(int level) const { return ((H - 1) >> level) + 1; }
+
+  int W = 0;
+  int H = 0;
+  std::vector<std::vector<int>> levels;
+};
@@ -13,6 +13,7 @@
 
 #include "fill_polygon.h"
 #include "manipulator_reach.h"
+#include "zobrist.h"
 #include "game.h"
 
 Wrapper::Wrapper(Game* game_, Point pos_, int wrapper_spawn_index_)
@@ -51,8 +52,6 @@ Action Wrapper::getScaffoldAction() {
 }
 
 bool Wrapper::isMoveable(char c) {
-  auto& map2d = game->map2d;
-
   {
     Point p {pos};
     switch (c) {
@@ -70,15 +69,10 @@ bool Wrapper::isMoveable(char c) {
       break;
     }
 
-    if (!map2d.isInside(p)) {
-      return false;
-    }
-    if ((map2d(p) & CellType::kObstacleBit) == 0) {
-      return true;
-    } else if (time_drill > 0) {
-      return true;
-    } else {
-      return false;
+    switch (game->obstacle_map(p)) {
+    case PaddedObstacleMap::kFree: return true;
+    case PaddedObstacleMap::kObstacle: return time_drill > 0;
+    default: return false;
     }
   }
 }
@@ -301,7 +295,11 @@ bool Wrapper::useBooster(char c) {
     break;
   }
   case Action::BEACON: {
+    if ((map2d(pos) & CellType::kTeleportTargetBit) == 0) {
+      game->map_hash ^= zobrist::cellKey(pos, CellType::kTeleportTargetBit);
+    }
     map2d(pos) |= CellType::kTeleportTargetBit;
+    game->booster_index.add(CellType::kTeleportTargetBit, pos);
     break;
   }
   }
@@ -334,14 +332,6 @@ Wrapper* Wrapper::cloneWrapper() {
   return spawned;
 }
 
-std::string Wrapper::getCommand() const {
-  std::ostringstream oss;
-  for (auto& a : actions) {
-    oss << a.command;
-  }
-  return oss.str();
-}
-
 bool Wrapper::undoAction() {
   auto& map2d = game->map2d;
   assert (!actions.empty());
@@ -350,6 +340,8 @@ bool Wrapper::undoAction() {
   // recover the state.
   Action a = actions.back();
   actions.pop_back();
+  assert (command_buffer.size() >= a.command.size());
+  command_buffer.resize(command_buffer.size() - a.command.size());
   // undo motion
   pos = a.old_position;
   direction = a.old_direction;
@@ -362,22 +354,30 @@ bool Wrapper::undoAction() {
     assert (map2d.isInside(p) && (map2d(p) & CellType::kWrappedBit) != 0);
     ++map2d.num_unwrapped;
     map2d(p) &= ~CellType::kWrappedBit;
+    game->map_hash ^= zobrist::cellKey(p, CellType::kWrappedBit);
+    game->unwrapped_pyramid.set(p, true);
   }
-  // undo drill
+  // undo drill. (the cells are also in absolute_new_wrapped_positions, so they were unwrapped above)
   for (auto p : a.break_walls) {
     assert (map2d.isInside(p) && (map2d(p) & CellType::kObstacleBit) == 0);
+    --map2d.num_unwrapped;
     map2d(p) |= CellType::kObstacleBit;
+    game->map_hash ^= zobrist::cellKey(p, CellType::kObstacleBit);
+    game->obstacle_map.set(p, true);
+    game->unwrapped_pyramid.set(p, false);
   }
   for (auto booster : boosters) {
+    // undo using boosters. (first, because a booster picked by this action can be used in the same action)
+    game->num_boosters[booster.booster_type] += a.use_booster[booster.booster_type];
     // undo picking boosters (place boosters)
     for (auto p : a.pick_boosters[booster.booster_type]) {
       assert (map2d.isInside(p) && (map2d(p) & booster.map_bit) == 0);
       map2d(p) |= booster.map_bit;
+      game->map_hash ^= zobrist::cellKey(p, booster.map_bit);
+      game->booster_index.add(booster.map_bit, p);
       game->num_boosters[booster.booster_type] -= 1;
       assert (game->num_boosters[booster.booster_type] >= 0);
     }
-    // undo using boosters
-    game->num_boosters[booster.booster_type] += a.use_booster[booster.booster_type];
   }
   if (a.use_booster[BoosterType::FAST_WHEEL]) {
     time_fast_wheels -= 50; // rule specification has updated.
@@ -389,16 +389,29 @@ bool Wrapper::undoAction() {
   if (a.use_booster[BoosterType::TELEPORT]) {
     assert (map2d.isInside(a.new_position) && (map2d(a.new_position) & CellType::kTeleportTargetBit) != 0);
     map2d(a.new_position) &= ~CellType::kTeleportTargetBit;
+    game->map_hash ^= zobrist::cellKey(a.new_position, CellType::kTeleportTargetBit);
+    game->booster_index.remove(CellType::kTeleportTargetBit, a.new_position);
   }
   // undo time
   if (a.fast_wheels_active) { time_fast_wheels += 1; }
   if (a.drill_active) { time_drill += 1; }
+  updateHash();
 
   return true;
 }
 
 void Wrapper::doAction(Action a) {
+  command_buffer += a.command;
   actions.push_back(a);
   if (time_fast_wheels > 0) --time_fast_wheels;
   if (time_drill > 0) --time_drill;
+  updateHash();
+}
+
+void Wrapper::updateHash() {
+  // clones in game->next_wrappers are not in wrapper_hash yet. (Game::hash() adds them)
+  if (index >= game->wrappers.size()) return;
+  game->wrapper_hash ^= hash_key;
+  hash_key = zobrist::wrapperKey(*this);
+  game->wrapper_hash ^= hash_key;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -25,7 +26,7 @@ struct Wrapper {
   Wrapper* cloneWrapper(); 
 
   Action getScaffoldAction();
-  std::string getCommand() const; // command for this wrapper.
+  const std::string& getCommand() const { return command_buffer; } // command for this wrapper.
   bool undoAction(); // if no actions are stacked, fail and return false.
 
   bool isMoveable(char);
@@ -33,12 +34,16 @@ struct Wrapper {
   int getLastNumWrapped() {
     return actions.empty() ? 0 : actions.back().absolute_new_wrapped_positions.size();
   }
+  // # of manipulators attached by B. (3 manipulators are attached initially)
+  int numAddedManipulators() const { return manipulators.size() - 3; }
 
   Game* game;
   Point pos;
   int index;
   Direction direction;
   std::vector<Action> actions;
+  // concatenation of actions[*].command. appended in doAction() and trimmed in undoAction().
+  std::string command_buffer;
   std::vector<Point> manipulators;
 
   // remained time of 'F'. While this is >0, speed becomes 2.
@@ -47,9 +52,12 @@ struct Wrapper {
   int time_drill = 0;
   // Gather wrappre stat information
   WrapperStat wrapper_stat;
+  // zobrist::wrapperKey(*this) while this is in game->wrappers. (a part of game->wrapper_hash)
+  uint64_t hash_key = 0;
 
 private:
   void pick(Action& a);
   void moveAndPaint(Point p, Action& a);
   void doAction(Action a);
+  void updateHash();
 };
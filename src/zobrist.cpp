@@ -0,0 +1,51 @@
+#include "zobrist.h"
+
+#include "wrapper.h"
+
+namespace zobrist {
+
+namespace {
+
+// tags keep the kinds of keys apart from cellKey().
+constexpr uint64_t kWrapperTag = 0x5752415050455221ull;
+constexpr uint64_t kManipulatorTag = 0x4d414e4950554c41ull;
+constexpr uint64_t kBoosterTag = 0x424f4f5354455253ull;
+
+uint64_t pointBits(Point p) {
+  return (uint64_t(uint32_t(p.y)) << 32) | uint32_t(p.x);
+}
+
+} // namespace
+
+uint64_t mapHash(const Map2D& map) {
+  uint64_t h = 0;
+  for (int y = 0; y < map.H; ++y) {
+    for (int x = 0; x < map.W; ++x) {
+      for (int bits = map(x, y); bits; bits &= bits - 1) {
+        h ^= cellKey({x, y}, bits & -bits);
+      }
+    }
+  }
+  return h;
+}
+
+uint64_t wrapperKey(const Wrapper& w) {
+  const uint64_t wrapper = mix(kWrapperTag ^ uint64_t(w.index));
+  uint64_t h = mix(wrapper ^ pointBits(w.pos));
+  h = mix(h ^ (uint64_t(w.direction) << 48) ^ (uint64_t(uint32_t(w.time_fast_wheels)) << 16) ^ uint64_t(uint32_t(w.time_drill)));
+  // manipulators are a set. (the order of attachment does not matter)
+  for (auto m : w.manipulators) {
+    h ^= mix(wrapper ^ kManipulatorTag ^ pointBits(m));
+  }
+  return h;
+}
+
+uint64_t boostersKey(const std::array<int, BoosterType::N>& num_boosters) {
+  uint64_t h = 0;
+  for (int b = 0; b < BoosterType::N; ++b) {
+    h = mix(h ^ kBoosterTag ^ (uint64_t(b) << 32) ^ uint32_t(num_boosters[b]));
+  }
+  return h;
+}
+
+} // namespace zobrist
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "base.h"
+#include "booster.h"
+#include "map2d.h"
+
+struct Wrapper;
+
+// 64-bit Zobrist keys of game states. keys are computed from the coordinates with a mixing function,
+// so no random table has to be sized for a map or shared between threads.
+namespace zobrist {
+
+// splitmix64 finalizer.
+inline uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// key of a CellType bit at p. toggled whenever the bit is set or cleared.
+inline uint64_t cellKey(Point p, int bit) {
+  return mix((uint64_t(uint32_t(p.y)) << 40) ^ (uint64_t(uint32_t(p.x)) << 16) ^ uint64_t(bit));
+}
+
+// XOR of cellKey() of all bits of all cells.
+uint64_t mapHash(const Map2D& map);
+// position, direction, timers and manipulators of a wrapper. (wrappers are distinguished by index)
+uint64_t wrapperKey(const Wrapper& w);
+// counts of unused boosters.
+uint64_t boostersKey(const std::array<int, BoosterType::N>& num_boosters);
+
+} // namespace zobrist